@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+///             Deck compiler
+///
+///
+/// Builds a deck and its indices once and writes them as a deck image that
+/// Quiz::loadQuiz and quiz_server map instead of parsing the JSON. Every
+/// process opening the image shares its pages; each keeps only its learner
+/// state and the item list.
+///
+/// Usage:   ./compile_deck [quiz_data.json] [quiz_data.deck]
+///                         [sentences.tsv] [kradfile-u]
+///
+/// The corpus and the KRADFILE are optional; without them the image has no
+/// fill-in-the-blank or confusable-kanji data.
+///
+/// @see     quiz_logic/deckimage.h
+///
+/// @file    compile_deck.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include "quiz_logic/quiz.h"
+
+int main(int argc, char* argv[]) {
+    std::string deckFile = argc > 1 ? argv[1] : "quiz_data.json";
+    std::string imageFile = argc > 2 ? argv[2] : Deck::imageFileFor(deckFile);
+    std::string sentenceFile = argc > 3 ? argv[3] : "sentences.tsv";
+    std::string kradFile = argc > 4 ? argv[4] : "kradfile-u";
+
+    // Always start from the JSON, not from an image of it.
+    std::remove(imageFile.c_str());
+
+    Quiz loader;
+    if (!loader.loadQuiz(deckFile)) {
+        return 1;
+    }
+    if (!loader.loadSentenceIndex(sentenceFile)) {
+        std::cerr << "No example sentences; the image has no Fill in the Blank data." << std::endl;
+    }
+    if (!loader.loadKanjiIndex(kradFile)) {
+        std::cerr << "No kanji decomposition data; the image has no Confusable Kanji data." << std::endl;
+    }
+
+    std::shared_ptr<const Deck> deck = loader.deck();
+    std::string error;
+    if (!deck->compile(imageFile, &error, deckFile)) {
+        std::cerr << "Failed to write " << imageFile << ": " << error << std::endl;
+        return 1;
+    }
+
+    std::shared_ptr<Deck> check = Deck::open(imageFile);
+    if (!check || check->items.size() != deck->items.size()) {
+        std::cerr << "Failed to read back " << imageFile << std::endl;
+        return 1;
+    }
+    std::cout << imageFile << ": " << deck->items.size() << " items, "
+              << deck->sentences.sentenceCount() << " sentences, "
+              << deck->kanji.kanjiCount() << " kanji, "
+              << check->image->mappedBytes() << " bytes" << std::endl;
+    return 0;
+}
@@ -1,6 +1,31 @@
 #include "quiz_logic/quiz.h"
+#include "utility/ttsclient.h"
+#include "utility/audiocache.h"
+#include "utility/querycache.h"
+#include "utility/ttsprefetch.h"
+#include "utility/speakercatalog.h"
+#include "utility/timestretch.h"
+#include "utility/audiopack.h"
+#include "utility/SdlAudioSink.h"
+#include <memory>
+#include <cstring>
 
-int main() {
+// Number of upcoming questions whose audio is synthesized ahead of time.
+static const size_t SPEECH_LOOKAHEAD = 3;
+
+// Voice that reads the questions, as named in Persona.json.
+static const char QUESTION_VOICE[] = "Kyushu Sora/Sexy";
+
+// What is read aloud for a question: the word itself.
+static SynthesisParams questionSpeech(const Vocab& vocab, int speaker) {
+    SynthesisParams params;
+    params.text = vocab.getKanji();
+    params.speaker = speaker;
+    params.trimSilence = true;  // the question should start the moment it plays
+    return params;
+}
+
+int main(int argc, char* argv[]) {
     /*
     // Load the data from the "quiz_data.json" file
     std::vector<Vocab> vocabList;
@@ -30,6 +55,99 @@ int main() {
  Quiz myQuiz;
     myQuiz.loadQuiz("quiz_data.json");
     myQuiz.loadQuizState();  // Load the quiz state before starting the quiz
+    myQuiz.watchDeck("quiz_data.json");  // Edits to the deck are taken up between questions
+
+    // ./main --speak reads every question aloud; the next questions are
+    // synthesized while the current one is being answered. ./main --listen
+    // only sets up the audio for listening comprehension (quiz type 8).
+    bool speak = false;
+    bool listen = false;
+    for (int i = 1; i < argc; ++i) {
+        speak = speak || std::strcmp(argv[i], "--speak") == 0;
+        listen = listen || std::strcmp(argv[i], "--listen") == 0;
+    }
+    std::unique_ptr<AudioCache> cache;
+    std::unique_ptr<QueryCache> queries;
+    std::unique_ptr<VoiceClient> voice;
+    std::unique_ptr<TtsPrefetcher> prefetcher;
+    std::unique_ptr<AudioSink> sink;
+    std::unique_ptr<StretchCache> stretches;
+    AudioPack pack;
+    std::future<size_t> speakerReady;
+    if (speak || listen) {
+        SpeakerCatalog speakers;
+        speakers.load();
+        int speaker = speakers.resolve(QUESTION_VOICE);
+        if (speaker < 0) speaker = SynthesisParams().speaker;
+
+        cache.reset(new AudioCache());
+        queries.reset(new QueryCache());
+        voice.reset(new VoiceClient(2));
+        // Load the voice model while the rest starts up.
+        speakerReady = warmUpSpeakers({ speaker }, voice->baseUrl());
+        std::string version = voice->fetchEngineVersion();
+        cache->setEngineVersion(version);
+        queries->setEngineVersion(version);
+        voice->setCache(cache.get());
+        voice->setQueryCache(queries.get());
+        prefetcher.reset(new TtsPrefetcher(*voice, *cache));
+        // Speech arrives as 24 kHz mono (the engine default); open the device in that format with a short buffer.
+        AudioEngine::instance().configure(AudioConfig::lowLatency());
+        // AUDIO_SINK=null runs without a sound device, with real clip timing.
+        sink = openAudioSink();
+        stretches.reset(new StretchCache());
+        // Recorded clips named after an item's romaji (e.g. tomodachi.wav) win over synthesis.
+        pack.open(AudioPack::DEFAULT_FILE);
+
+        myQuiz.setUpcomingListener([&, speaker](const std::vector<Vocab>& upcoming) {
+            std::vector<SynthesisParams> speech;
+            for (const Vocab& vocab : upcoming) {
+                if (!pack.isOpen() || !pack.find(vocab.getRomaji())) {
+                    speech.push_back(questionSpeech(vocab, speaker));
+                }
+            }
+            prefetcher->schedule(speech);
+        }, SPEECH_LOOKAHEAD);
+
+        // A question's audio: its pack clip if there is one, otherwise its
+        // speech, prefetched or cached by now; only a cold start waits on the engine.
+        auto questionAudio = [&, speaker](const Vocab& vocab, std::vector<uint8_t>& audio) {
+            const AudioPackEntry* clip = pack.isOpen() ? pack.find(vocab.getRomaji()) : nullptr;
+            if (clip) {
+                audio.assign(pack.data(*clip), pack.data(*clip) + clip->length);
+                return true;
+            }
+            SynthesisResult result = prefetcher->fetch(questionSpeech(vocab, speaker)).get();
+            if (!result.ok) {
+                std::cerr << "Failed to synthesize question audio: " << result.error << std::endl;
+                return false;
+            }
+            audio.swap(result.audio);
+            return true;
+        };
+
+        myQuiz.setAudioHook([&, questionAudio](const Vocab& vocab, double speed) {
+            std::vector<uint8_t> audio;
+            if (!questionAudio(vocab, audio)) {
+                return false;
+            }
+            if (speed != 1.0) {
+                std::shared_ptr<const std::vector<uint8_t>> stretched = stretches->get(audio, speed);
+                if (stretched) audio = *stretched;
+            }
+            return sink->play(audio);
+        });
+
+        if (speak) {
+            myQuiz.setQuestionHook([&, questionAudio](const Vocab& vocab) {
+                std::vector<uint8_t> audio;
+                if (questionAudio(vocab, audio)) {
+                    sink->play(audio);
+                }
+            });
+        }
+    }
+
     myQuiz.startQuiz();
     myQuiz.printStatistics();
     myQuiz.saveQuizState();  // Save the quiz state after finishing the quiz
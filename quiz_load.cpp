@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////
+///             Quiz server load test
+///
+///
+/// Simulates many learners against quiz_server. All clients connect first,
+/// so the server holds every session at once, then each starts a quiz,
+/// answers its questions and quits. Reports throughput and per-command
+/// latency percentiles, and fails if any client got an error or a wrong
+/// question count.
+///
+/// Usage:   ./quiz_load [clients 2000] [questions 10] [port 50124] [type 1]
+///
+/// @see     quiz_server.cpp
+///
+/// @file    quiz_load.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+typedef std::chrono::steady_clock Clock;
+
+// Connects in flight at once; more than the listen backlog only adds SYN retries.
+static const size_t MAX_CONNECTING = 256;
+
+struct Client {
+    int fd = -1;
+    bool connected = false;
+    bool done = false;
+    bool failed = false;
+    size_t answered = 0;
+    std::string input;
+    Clock::time_point sentAt;
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static bool sendLine(Client& client, const std::string& line) {
+    std::string data = line + "\n";
+    client.sentAt = Clock::now();
+    // A command is far smaller than the socket buffer, so it goes in one call.
+    return send(client.fd, data.data(), data.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(data.size());
+}
+
+int main(int argc, char* argv[]) {
+    size_t clientCount = argc > 1 ? std::stoul(argv[1]) : 2000;
+    size_t questions = argc > 2 ? std::stoul(argv[2]) : 10;
+    int port = argc > 3 ? std::stoi(argv[3]) : 50124;
+    int type = argc > 4 ? std::stoi(argv[4]) : 1;
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int epollFd = epoll_create1(0);
+    std::vector<Client> clients(clientCount);
+    std::vector<double> latencies;
+    latencies.reserve(clientCount * (questions + 2));
+    size_t next = 0, connecting = 0, finished = 0, failed = 0, open = 0, peakOpen = 0;
+    bool started = false;
+
+    size_t reported = 0;
+    auto fail = [&](Client& client, const std::string& why) {
+        if (!client.failed && reported++ < 5) std::cerr << "Client " << (&client - clients.data()) << ": " << why << std::endl;
+        client.failed = true;
+    };
+    auto finish = [&](Client& client) {
+        if (!client.connected) --connecting;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+        close(client.fd);
+        --open;
+        ++finished;
+        if (client.failed || !client.done) ++failed;
+    };
+
+    auto start = Clock::now();
+    while (finished < clientCount) {
+        while (next < clientCount && connecting < MAX_CONNECTING) {
+            Client& client = clients[next];
+            client.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (client.fd < 0) {
+                std::cerr << "socket: " << std::strerror(errno) << " (raise ulimit -n)" << std::endl;
+                return 1;
+            }
+            int yes = 1;
+            setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+            connect(client.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            epoll_event event;
+            std::memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN | EPOLLOUT;
+            event.data.u64 = next;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, client.fd, &event);
+            ++next;
+            ++connecting;
+            peakOpen = std::max(peakOpen, ++open);
+        }
+
+        if (!started && next == clientCount && connecting == 0) {
+            started = true;
+            for (auto& client : clients) {
+                if (!client.connected || client.failed) continue;
+                if (!sendLine(client, "start " + std::to_string(type) + " " + std::to_string(questions))) {
+                    fail(client, "send failed");
+                    finish(client);
+                }
+            }
+        }
+
+        epoll_event events[512];
+        int ready = epoll_wait(epollFd, events, 512, 10000);
+        if (ready == 0) {
+            std::cerr << "No progress for 10 s; " << (clientCount - finished) << " clients stuck." << std::endl;
+            return 1;
+        }
+        for (int i = 0; i < ready; ++i) {
+            Client& client = clients[events[i].data.u64];
+            if (!client.connected) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(client.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                if (error != 0 || (events[i].events & (EPOLLERR | EPOLLHUP))) {
+                    fail(client, std::string("connect: ") + std::strerror(error));
+                    finish(client);
+                    continue;
+                }
+                client.connected = true;
+                --connecting;
+                epoll_event event;
+                std::memset(&event, 0, sizeof(event));
+                event.events = EPOLLIN;
+                event.data.u64 = events[i].data.u64;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+                continue;
+            }
+
+            char chunk[4096];
+            ssize_t n = recv(client.fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+            if (n <= 0) {
+                if (!client.done) fail(client, "server closed the connection early");
+                finish(client);
+                continue;
+            }
+            client.input.append(chunk, static_cast<size_t>(n));
+
+            size_t end;
+            bool closed = false;
+            while (!closed && (end = client.input.find('\n')) != std::string::npos) {
+                latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - client.sentAt).count());
+                json reply = json::parse(client.input.substr(0, end), nullptr, false);
+                client.input.erase(0, end + 1);
+
+                std::string command;
+                if (reply.is_discarded() || reply.contains("error")) {
+                    fail(client, reply.is_discarded() ? "unreadable reply" : reply["error"].get<std::string>());
+                    command = "quit";
+                } else if (reply.contains("bye")) {
+                    finish(client);
+                    closed = true;
+                    continue;
+                } else if (reply.contains("question")) {
+                    if (reply.contains("result")) ++client.answered;
+                    // Answers the reading of the first item; scores vary, counts must not.
+                    command = "answer ともだち";
+                } else if (reply.value("done", false)) {
+                    ++client.answered;
+                    client.done = true;
+                    if (client.answered != questions || reply["total"].get<size_t>() != questions) {
+                        fail(client, "answered " + std::to_string(client.answered) + ", server counted " + reply["total"].dump());
+                    }
+                    command = "quit";
+                } else {
+                    fail(client, "unexpected reply " + reply.dump());
+                    command = "quit";
+                }
+                if (!sendLine(client, command)) {
+                    fail(client, "send failed");
+                    finish(client);
+                    closed = true;
+                }
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::fixed << std::setprecision(1)
+              << clientCount << " clients (" << peakOpen << " open at once), " << questions << " questions each, "
+              << failed << " failed, " << seconds << " s, "
+              << (seconds > 0 ? latencies.size() / seconds : 0) << " commands/s" << std::endl
+              << std::setprecision(2)
+              << "latency ms: p50 " << percentile(latencies, 0.50) << ", p99 " << percentile(latencies, 0.99)
+              << ", max " << (latencies.empty() ? 0.0 : latencies.back()) << std::endl;
+    close(epollFd);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,389 @@
+#ifndef CONJUGATION_H_
+#define CONJUGATION_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "vocab.h"
+#include "vocablist.h"
+#include "itemkeys.h"
+#include "flatarray.h"
+#include "deckimage.h"
+
+/**
+ * @brief Word classes the conjugation tables know about.
+ */
+enum class WordClass {
+    None,
+    Godan,        // u-verb
+    Ichidan,      // ru-verb
+    Suru,         // する and noun + する
+    Kuru,         // くる
+    IAdjective,
+    NaAdjective
+};
+
+/**
+ * @brief Conjugated forms generated for every verb / adjective.
+ */
+enum class ConjugationForm {
+    Te = 0,
+    Past,
+    Negative,
+    Polite,
+    Count
+};
+
+/**
+ * @brief Non-owning view into the conjugation string pool.
+ */
+struct FormView {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return size == 0; }
+    std::string str() const { return std::string(data, size); }
+    bool equals(const std::string& other) const {
+        return other.size() == size && std::memcmp(other.data(), data, size) == 0;
+    }
+};
+
+/**
+ * @brief Precomputed conjugation drills for a deck.
+ *
+ * Forms are generated once at load from kana row tables and packed into a
+ * single string pool with one offset per (item, form), so serving a drill
+ * is an index lookup. Only the hiragana reading is conjugated.
+ */
+class ConjugationTable {
+public:
+    static const size_t FORM_COUNT = static_cast<size_t>(ConjugationForm::Count);
+
+    size_t build(const VocabList& vocabList);
+    bool empty() const { return conjugable_.empty(); }
+
+    /** @brief Adds the pool and offsets to a deck image. */
+    void writeImage(DeckImageWriter& image) const;
+    /** @brief Reads the pool and offsets in place; keys are those of the deck the image was built from. */
+    bool readImage(const DeckImage& image, const ItemKeys& keys);
+
+    bool hasForms(const Vocab& vocab) const;
+    FormView form(const Vocab& vocab, ConjugationForm form) const;
+    /** @brief The same by the item's index in the deck, without looking it up. */
+    bool hasForms(size_t item) const;
+    FormView form(size_t item, ConjugationForm form) const;
+    std::vector<size_t> conjugableItems() const { return std::vector<size_t>(conjugable_.begin(), conjugable_.end()); }
+
+    /**
+     * @brief Word class from the part-of-speech tag; a plain "verb" is
+     *        guessed from its ending, kanji telling apart godan verbs that
+     *        look ichidan (帰る / 変える).
+     */
+    static WordClass classify(const std::string& partOfSpeech, const std::string& hiragana,
+                              const std::string& kanji = std::string());
+    static bool conjugate(const std::string& hiragana, WordClass wordClass, std::string (&forms)[FORM_COUNT]);
+    static const char* formName(ConjugationForm form);
+
+private:
+    struct GodanRow {
+        const char* dictionary; /**< u-row ending, e.g. "く" */
+        const char* aRow;       /**< negative stem ending */
+        const char* iRow;       /**< polite stem ending */
+        const char* te;         /**< te-form ending */
+        const char* ta;         /**< past ending */
+    };
+
+    static const GodanRow GODAN_ROWS[];
+    static const char* const GODAN_RU_KANJI[];  /**< e/i-row + る verbs that are godan, by kanji */
+    static const char* const GODAN_RU_KANA[];   /**< the same by reading, where no ichidan verb shares it */
+    static const char* const NA_ADJECTIVES_KANJI[];  /**< na-adjectives ending in い, by kanji */
+    static const char* const NA_ADJECTIVES_KANA[];   /**< the same by reading */
+    static const size_t KANA_BYTES = 3;  // every kana used here is 3 bytes in UTF-8
+
+    static bool endsWith(const std::string& str, const char* suffix);
+    static bool isNaAdjective(const std::string& hiragana, const std::string& kanji);
+    static bool isKuru(const std::string& hiragana, const std::string& kanji);
+
+    FlatArray<char> pool_;
+    FlatArray<uint32_t> offsets_;  /**< (item * FORM_COUNT + form) -> pool offset, plus end */
+    FlatArray<uint32_t> conjugable_;
+    ItemKeys keys_;
+};
+
+const ConjugationTable::GodanRow ConjugationTable::GODAN_ROWS[] = {
+    { "う", "わ", "い", "って", "った" },
+    { "く", "か", "き", "いて", "いた" },
+    { "ぐ", "が", "ぎ", "いで", "いだ" },
+    { "す", "さ", "し", "して", "した" },
+    { "つ", "た", "ち", "って", "った" },
+    { "ぬ", "な", "に", "んで", "んだ" },
+    { "ぶ", "ば", "び", "んで", "んだ" },
+    { "む", "ま", "み", "んで", "んだ" },
+    { "る", "ら", "り", "って", "った" },
+};
+
+const char* const ConjugationTable::GODAN_RU_KANJI[] = {
+    "帰る", "入る", "知る", "走る", "切る", "要る", "減る", "喋る", "滑る", "蹴る", "限る", "参る",
+    "握る", "照る", "散る", "混じる", "交じる", "焦る", "湿る", "練る", "茂る", "遮る", "捻る",
+    "蘇る", "甦る", "陥る", "覆る", "嘲る", "罵る", "翻る", "弄る", "詰る", "千切る", "捩る"
+};
+
+const char* const ConjugationTable::GODAN_RU_KANA[] = {
+    "はいる", "しる", "はしる", "しゃべる", "すべる", "ける", "かぎる", "まいる", "にぎる", "ちる",
+    "まじる", "あせる", "しげる", "さえぎる", "ひねる", "よみがえる", "おちいる", "くつがえる",
+    "あざける", "ののしる", "ひるがえる", "いじる", "なじる", "ちぎる", "よじる"
+};
+
+const char* const ConjugationTable::NA_ADJECTIVES_KANJI[] = {
+    "綺麗", "奇麗", "嫌い", "有名", "得意", "丁寧", "失礼", "曖昧", "愉快", "透明", "安定", "無礼", "不得意"
+};
+
+const char* const ConjugationTable::NA_ADJECTIVES_KANA[] = {
+    "きれい", "きらい", "だいきらい", "ゆうめい", "とくい", "ふとくい", "ていねい", "しつれい", "あいまい",
+    "ゆかい", "ふゆかい", "とうめい", "あんてい", "ふあんてい", "ぶれい", "ぞんざい"
+};
+
+bool ConjugationTable::endsWith(const std::string& str, const char* suffix) {
+    size_t length = std::strlen(suffix);
+    return str.size() >= length && str.compare(str.size() - length, length, suffix) == 0;
+}
+
+const char* ConjugationTable::formName(ConjugationForm form) {
+    switch (form) {
+        case ConjugationForm::Te: return "te-form";
+        case ConjugationForm::Past: return "plain past";
+        case ConjugationForm::Negative: return "plain negative";
+        case ConjugationForm::Polite: return "polite (masu) form";
+        default: return "";
+    }
+}
+
+bool ConjugationTable::isNaAdjective(const std::string& hiragana, const std::string& kanji) {
+    if (!endsWith(hiragana, "い")) return true;
+    for (const char* word : NA_ADJECTIVES_KANJI) {
+        if (!kanji.empty() && endsWith(kanji, word)) return true;
+    }
+    for (const char* word : NA_ADJECTIVES_KANA) {
+        if (hiragana == word) return true;
+    }
+    return false;
+}
+
+bool ConjugationTable::isKuru(const std::string& hiragana, const std::string& kanji) {
+    // 来る and compounds such as 持って来る / もってくる; つくる and めくる are godan,
+    // and 出来る is read できる.
+    return hiragana == "くる" || endsWith(hiragana, "てくる") || endsWith(hiragana, "でくる") ||
+           (endsWith(kanji, "来る") && endsWith(hiragana, "くる"));
+}
+
+WordClass ConjugationTable::classify(const std::string& partOfSpeech, const std::string& hiragana,
+                                     const std::string& kanji) {
+    // Whole tokens only: "adverb" is not a verb. Tags look like "u-verb",
+    // "irregular verb", "na-adjective" or "adj-na".
+    std::vector<std::string> tokens;
+    std::string token;
+    for (char c : partOfSpeech + " ") {
+        if (c == ' ' || c == ',' || c == ';' || c == '/' || c == '(' || c == ')') {
+            if (!token.empty()) tokens.push_back(token);
+            token.clear();
+        } else {
+            token += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    auto has = [&](const char* wanted) { return std::find(tokens.begin(), tokens.end(), wanted) != tokens.end(); };
+    auto any = [&](bool (*match)(const std::string&)) { return std::find_if(tokens.begin(), tokens.end(), match) != tokens.end(); };
+
+    if (any([](const std::string& t) { return t.compare(0, 3, "adj") == 0 || t.find("-adj") != std::string::npos; })) {
+        if (any([](const std::string& t) { return t.compare(0, 3, "na-") == 0 || t == "adj-na" || t.find("な") != std::string::npos; })) {
+            return WordClass::NaAdjective;
+        }
+        if (any([](const std::string& t) { return t.compare(0, 2, "i-") == 0 || t == "adj-i" || t.find("い") != std::string::npos; })) {
+            return WordClass::IAdjective;
+        }
+        // A bare "adjective" ending in い is an i-adjective unless it is a
+        // known na-adjective such as きれい or ゆうめい.
+        return isNaAdjective(hiragana, kanji) ? WordClass::NaAdjective : WordClass::IAdjective;
+    }
+    bool verb = any([](const std::string& t) {
+        return t == "verb" || endsWith(t, "-verb") || t == "ichidan" || t == "godan";
+    });
+    if (!verb) return WordClass::None;
+
+    if (endsWith(hiragana, "する")) return WordClass::Suru;
+    if (isKuru(hiragana, kanji)) return WordClass::Kuru;
+    if (has("ru-verb") || has("ichidan")) return WordClass::Ichidan;
+    if (has("u-verb") || has("godan")) return WordClass::Godan;
+
+    // Plain "verb": e/i-row + る is ichidan unless it is one of the godan
+    // verbs that only look like it. Kanji decide homophones (切る / 着る);
+    // a reading is only trusted where no ichidan verb shares it.
+    for (const char* exception : GODAN_RU_KANJI) {
+        if (!kanji.empty() && endsWith(kanji, exception)) return WordClass::Godan;
+    }
+    if (kanji.empty() || kanji == hiragana) {
+        for (const char* exception : GODAN_RU_KANA) {
+            if (hiragana == exception) return WordClass::Godan;
+        }
+    }
+    if (endsWith(hiragana, "る") && hiragana.size() >= 2 * KANA_BYTES) {
+        static const char* const EI_ROW[] = {
+            "え", "け", "げ", "せ", "ぜ", "て", "で", "ね", "へ", "べ", "め", "れ",
+            "い", "き", "ぎ", "し", "じ", "ち", "に", "ひ", "び", "み", "り"
+        };
+        std::string before = hiragana.substr(hiragana.size() - 2 * KANA_BYTES, KANA_BYTES);
+        for (const char* kana : EI_ROW) {
+            if (before == kana) return WordClass::Ichidan;
+        }
+    }
+    return WordClass::Godan;
+}
+
+bool ConjugationTable::conjugate(const std::string& hiragana, WordClass wordClass, std::string (&forms)[FORM_COUNT]) {
+    const size_t te = static_cast<size_t>(ConjugationForm::Te);
+    const size_t past = static_cast<size_t>(ConjugationForm::Past);
+    const size_t negative = static_cast<size_t>(ConjugationForm::Negative);
+    const size_t polite = static_cast<size_t>(ConjugationForm::Polite);
+
+    switch (wordClass) {
+        case WordClass::Ichidan: {
+            if (!endsWith(hiragana, "る")) return false;
+            std::string stem = hiragana.substr(0, hiragana.size() - KANA_BYTES);
+            forms[te] = stem + "て";
+            forms[past] = stem + "た";
+            forms[negative] = stem + "ない";
+            forms[polite] = stem + "ます";
+            return true;
+        }
+        case WordClass::Godan: {
+            for (const GodanRow& row : GODAN_ROWS) {
+                if (!endsWith(hiragana, row.dictionary)) continue;
+                std::string stem = hiragana.substr(0, hiragana.size() - KANA_BYTES);
+                bool iku = hiragana == "いく" || endsWith(hiragana, "ていく");
+                forms[te] = stem + (iku ? "って" : row.te);
+                forms[past] = stem + (iku ? "った" : row.ta);
+                forms[negative] = hiragana == "ある" ? std::string("ない") : stem + row.aRow + "ない";
+                forms[polite] = stem + row.iRow + "ます";
+                return true;
+            }
+            return false;
+        }
+        case WordClass::Suru: {
+            std::string stem = hiragana.substr(0, hiragana.size() - 2 * KANA_BYTES);
+            forms[te] = stem + "して";
+            forms[past] = stem + "した";
+            forms[negative] = stem + "しない";
+            forms[polite] = stem + "します";
+            return true;
+        }
+        case WordClass::Kuru: {
+            if (!endsWith(hiragana, "くる")) return false;
+            std::string stem = hiragana.substr(0, hiragana.size() - 2 * KANA_BYTES);
+            forms[te] = stem + "きて";
+            forms[past] = stem + "きた";
+            forms[negative] = stem + "こない";
+            forms[polite] = stem + "きます";
+            return true;
+        }
+        case WordClass::IAdjective: {
+            std::string stem = hiragana.substr(0, hiragana.size() - KANA_BYTES);
+            // いい and its compounds (かっこいい) conjugate from よい; かわいい does not.
+            if (endsWith(hiragana, "いい") && !endsWith(hiragana, "かわいい")) {
+                stem = hiragana.substr(0, hiragana.size() - 2 * KANA_BYTES) + "よ";
+            }
+            forms[te] = stem + "くて";
+            forms[past] = stem + "かった";
+            forms[negative] = stem + "くない";
+            forms[polite] = hiragana + "です";
+            return true;
+        }
+        case WordClass::NaAdjective:
+            forms[te] = hiragana + "で";
+            forms[past] = hiragana + "だった";
+            forms[negative] = hiragana + "じゃない";
+            forms[polite] = hiragana + "です";
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t ConjugationTable::build(const VocabList& vocabList) {
+    std::vector<char>& pool = pool_.edit();
+    std::vector<uint32_t>& offsets = offsets_.edit();
+    std::vector<uint32_t>& conjugable = conjugable_.edit();
+    pool.clear();
+    offsets.clear();
+    conjugable.clear();
+
+    offsets.reserve(vocabList.size() * FORM_COUNT + 1);
+    std::string forms[FORM_COUNT];
+
+    for (size_t i = 0; i < vocabList.size(); ++i) {
+        const Vocab vocab = vocabList[i];
+        const std::string hiragana = vocab.getHiragana();
+        WordClass wordClass = classify(vocab.getPartOfSpeech(), hiragana, vocab.getKanji());
+        bool ok = wordClass != WordClass::None && conjugate(hiragana, wordClass, forms);
+
+        for (size_t f = 0; f < FORM_COUNT; ++f) {
+            offsets.push_back(static_cast<uint32_t>(pool.size()));
+            if (ok) pool.insert(pool.end(), forms[f].begin(), forms[f].end());
+        }
+        if (ok) conjugable.push_back(static_cast<uint32_t>(i));
+    }
+    offsets.push_back(static_cast<uint32_t>(pool.size()));
+    pool.shrink_to_fit();
+    keys_.build(vocabList);
+    return conjugable.size();
+}
+
+void ConjugationTable::writeImage(DeckImageWriter& image) const {
+    image.add(DeckSection::ConjugationPool, pool_);
+    image.add(DeckSection::ConjugationOffsets, offsets_);
+    image.add(DeckSection::ConjugationItems, conjugable_);
+}
+
+bool ConjugationTable::readImage(const DeckImage& image, const ItemKeys& keys) {
+    FlatArray<uint32_t> offsets = image.section<uint32_t>(DeckSection::ConjugationOffsets);
+    FlatArray<char> pool = image.section<char>(DeckSection::ConjugationPool);
+    FlatArray<uint32_t> conjugable = image.section<uint32_t>(DeckSection::ConjugationItems);
+    if (offsets.size() != keys.size() * FORM_COUNT + 1 || !DeckImage::validOffsets(offsets, pool.size())) {
+        return false;
+    }
+    // Conjugable items are deck items in ascending order.
+    for (size_t i = 0; i < conjugable.size(); ++i) {
+        if (conjugable[i] >= keys.size() || (i > 0 && conjugable[i] <= conjugable[i - 1])) return false;
+    }
+    pool_ = pool;
+    offsets_ = offsets;
+    conjugable_ = conjugable;
+    keys_ = keys;
+    return true;
+}
+
+bool ConjugationTable::hasForms(const Vocab& vocab) const {
+    return !form(vocab, ConjugationForm::Te).empty();
+}
+
+FormView ConjugationTable::form(const Vocab& vocab, ConjugationForm form) const {
+    size_t item = keys_.find(vocab);
+    return item == ItemKeys::NOT_FOUND ? FormView() : this->form(item, form);
+}
+
+bool ConjugationTable::hasForms(size_t item) const {
+    return !form(item, ConjugationForm::Te).empty();
+}
+
+FormView ConjugationTable::form(size_t item, ConjugationForm form) const {
+    FormView view;
+    size_t slot = item * FORM_COUNT + static_cast<size_t>(form);
+    if (item >= keys_.size() || slot + 1 >= offsets_.size()) return view;
+
+    view.data = pool_.data() + offsets_[slot];
+    view.size = offsets_[slot + 1] - offsets_[slot];
+    return view;
+}
+
+#endif  // CONJUGATION_H_
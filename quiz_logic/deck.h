@@ -0,0 +1,169 @@
+#ifndef DECK_H_
+#define DECK_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <sys/stat.h>
+
+#include "vocab.h"
+#include "vocablist.h"
+#include "itemkeys.h"
+#include "deckimage.h"
+#include "sentenceindex.h"
+#include "kanjiindex.h"
+#include "conjugation.h"
+
+/**
+ * @brief The items of a quiz and the indices derived from them.
+ *
+ * Everything here is read while questions are asked and nothing is written,
+ * so once built a deck is shared (std::shared_ptr<const Deck>) by every
+ * session quizzing on it. Per-learner data lives in LearnerState.
+ *
+ * compile() writes the deck as a DeckImage and open() maps one back: the
+ * items and the indices then read their arrays in place, so processes
+ * opening the same image share those pages instead of each building its
+ * own copy.
+ */
+struct Deck {
+    VocabList items;
+    SentenceIndex sentences;
+    KanjiIndex kanji;
+    ConjugationTable conjugations;
+    std::shared_ptr<const DeckImage> image;  /**< Keeps the mapping alive when opened from an image. */
+
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+    static const char IMAGE_EXTENSION[];
+
+    /** @return The index of an item of this deck (a view from items), or NOT_FOUND. */
+    size_t indexOf(const Vocab& vocab) const { return items.indexOf(vocab); }
+
+    /** @return How items are told apart across deck versions: kanji and hiragana. */
+    static std::string itemKey(const Vocab& vocab) { return ItemKeys::key(vocab); }
+
+    /**
+     * @brief Writes the deck and its indices as an image; see DeckImage.
+     * @param sourceFile The file the deck was loaded from, if any. Its size and
+     *        modification time are stored so imageIsCurrent() can tell when it changes.
+     */
+    bool compile(const std::string& imageFile, std::string* error = nullptr,
+                 const std::string& sourceFile = std::string()) const;
+
+    /** @return The deck in an image, or nullptr if it cannot be read. */
+    static std::shared_ptr<Deck> open(const std::string& imageFile);
+
+    /** @return Where the image compiled from a deck file goes: quiz_data.json -> quiz_data.deck. */
+    static std::string imageFileFor(const std::string& deckFile);
+
+    /**
+     * @return True if imageFile was compiled from deckFile as it is now: the
+     *         size and nanosecond modification time stored in the image match
+     *         the file's. An image without them is never current for a deckFile
+     *         that exists.
+     */
+    static bool imageIsCurrent(const std::string& imageFile, const std::string& deckFile);
+};
+
+const size_t Deck::NOT_FOUND;
+const char Deck::IMAGE_EXTENSION[] = ".deck";
+
+namespace deck_detail {
+
+/** @brief Size and modification time of the file an image was compiled from. */
+struct SourceStamp {
+    uint64_t bytes;
+    int64_t modifiedSeconds;
+    int64_t modifiedNanoseconds;
+};
+
+inline bool stampOf(const std::string& file, SourceStamp& stamp) {
+    struct stat info;
+    if (stat(file.c_str(), &info) != 0) return false;
+    stamp.bytes = static_cast<uint64_t>(info.st_size);
+    stamp.modifiedSeconds = static_cast<int64_t>(info.st_mtim.tv_sec);
+    stamp.modifiedNanoseconds = static_cast<int64_t>(info.st_mtim.tv_nsec);
+    return true;
+}
+
+}  // namespace deck_detail
+
+bool Deck::compile(const std::string& imageFile, std::string* error, const std::string& sourceFile) const {
+    using deck_detail::SourceStamp;
+    // The items are already flat; their arrays are written as they are.
+    ItemKeys keys;
+    keys.build(items);
+
+    DeckImageWriter writer;
+    writer.add(DeckSection::Strings, items.strings());
+    writer.add(DeckSection::Items, items.records());
+    writer.add(DeckSection::English, items.english());
+    keys.writeImage(writer);
+    conjugations.writeImage(writer);
+    sentences.writeImage(writer);
+    kanji.writeImage(writer);
+
+    SourceStamp stamp;
+    if (!sourceFile.empty()) {
+        if (!deck_detail::stampOf(sourceFile, stamp)) {
+            if (error) *error = "cannot stat " + sourceFile;
+            return false;
+        }
+        writer.add(DeckSection::SourceStamp, &stamp, 1);
+    }
+    return writer.write(imageFile, error);
+}
+
+std::shared_ptr<Deck> Deck::open(const std::string& imageFile) {
+    std::shared_ptr<DeckImage> mapped = std::make_shared<DeckImage>();
+    if (!mapped->open(imageFile)) {
+        return nullptr;
+    }
+
+    // Nothing is copied: the items and every index view the mapping, and
+    // one set of item keys serves the lookups of all the indices.
+    std::shared_ptr<Deck> deck = std::make_shared<Deck>();
+    deck->items = VocabList::view(mapped->section<VocabRecord>(DeckSection::Items),
+                                  mapped->section<VocabText>(DeckSection::English),
+                                  mapped->section<char>(DeckSection::Strings));
+    ItemKeys keys;
+    if (!deck->items.consistent() || !keys.readImage(*mapped, deck->items.size()) ||
+        !deck->conjugations.readImage(*mapped, keys) ||
+        !deck->sentences.readImage(*mapped, keys) ||
+        !deck->kanji.readImage(*mapped)) {
+        std::cerr << "Invalid deck image: " << imageFile << std::endl;
+        return nullptr;
+    }
+    deck->image = mapped;
+    return deck;
+}
+
+std::string Deck::imageFileFor(const std::string& deckFile) {
+    size_t dot = deckFile.find_last_of('.');
+    size_t slash = deckFile.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return deckFile + IMAGE_EXTENSION;
+    }
+    return deckFile.substr(0, dot) + IMAGE_EXTENSION;
+}
+
+bool Deck::imageIsCurrent(const std::string& imageFile, const std::string& deckFile) {
+    using deck_detail::SourceStamp;
+    struct stat image;
+    if (stat(imageFile.c_str(), &image) != 0) return false;
+    SourceStamp source;
+    if (!deck_detail::stampOf(deckFile, source)) return true;
+
+    // Whole-second times would miss an edit made in the second the image was
+    // written, so the stamp is compared exactly, size included.
+    DeckImage mapped;
+    if (!mapped.open(imageFile)) return false;
+    FlatArray<SourceStamp> stamp = mapped.section<SourceStamp>(DeckSection::SourceStamp);
+    return stamp.size() == 1 && stamp[0].bytes == source.bytes &&
+           stamp[0].modifiedSeconds == source.modifiedSeconds &&
+           stamp[0].modifiedNanoseconds == source.modifiedNanoseconds;
+}
+
+#endif  // DECK_H_
@@ -0,0 +1,301 @@
+#ifndef DECKIMAGE_H_
+#define DECKIMAGE_H_
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "flatarray.h"
+
+/**
+ * @brief What a section of a deck image holds. Values are part of the file
+ *        format; append new ones.
+ */
+enum class DeckSection : uint32_t {
+    Strings = 1,
+    Items,
+    English,
+    ConjugationPool,
+    ConjugationOffsets,
+    ConjugationItems,
+    SentenceText,
+    Sentences,
+    SentenceOffsets,
+    SentencePostings,
+    SentenceFingerprint,
+    KanjiCodes,
+    KanjiRows,
+    KanjiRowIndex,
+    KanjiSimilarIndex,
+    KanjiSimilarOffsets,
+    KanjiSimilar,
+    KanjiComponents,
+    SourceStamp,
+    ItemKeys
+};
+
+/**
+ * @brief A compiled deck in one read-only file, mapped with one mmap and
+ *        shared by every process that opens it.
+ *
+ * Layout (native byte order; compile the image on the machine that uses it):
+ *
+ *     "JTDK" | version u32 | count u32 | reserved u32
+ *     SectionEntry[count]
+ *     section data      arrays of plain structs, 16-byte aligned
+ *
+ * An index reads its arrays in place through section<T>(), so the pages
+ * behind them are the page cache's and not the process's. The sections are
+ * written by Deck::compile and the indices' writeImage().
+ */
+class DeckImage {
+public:
+    static const char MAGIC[4];
+    static const uint32_t VERSION = 2;
+
+    struct SectionEntry {
+        uint32_t id;
+        uint32_t elementBytes;  /**< sizeof the stored struct; checked on read. */
+        uint64_t offset;        /**< From the start of the image. */
+        uint64_t bytes;
+    };
+
+    DeckImage() = default;
+    ~DeckImage() { close(); }
+
+    DeckImage(const DeckImage&) = delete;
+    DeckImage& operator=(const DeckImage&) = delete;
+
+    bool open(const std::string& imageFile);
+    void close();
+    bool isOpen() const { return base_ != nullptr; }
+    size_t mappedBytes() const { return mappedBytes_; }
+
+    bool has(DeckSection id) const { return find(id) != nullptr; }
+
+    /** @return A view of the section; empty if it is absent or not an array of T. */
+    template <typename T>
+    FlatArray<T> section(DeckSection id) const;
+
+    /** @return A section of chars as a string (copied). */
+    std::string text(DeckSection id) const;
+
+    /**
+     * @return True if offsets are CSR row offsets into an array of count
+     *         elements: starting at 0, never decreasing and ending at count.
+     *         Readers check this before indexing with a section's offsets.
+     */
+    static bool validOffsets(const FlatArray<uint32_t>& offsets, size_t count);
+
+private:
+    const SectionEntry* find(DeckSection id) const;
+
+    const uint8_t* base_ = nullptr;
+    size_t mappedBytes_ = 0;
+    const SectionEntry* sections_ = nullptr;
+    size_t count_ = 0;
+};
+
+/**
+ * @brief Collects sections and writes them as a DeckImage.
+ */
+class DeckImageWriter {
+public:
+    template <typename T>
+    void add(DeckSection id, const T* data, size_t count);
+
+    template <typename T>
+    void add(DeckSection id, const std::vector<T>& values) { add(id, values.data(), values.size()); }
+    template <typename T>
+    void add(DeckSection id, const FlatArray<T>& values) { add(id, values.data(), values.size()); }
+    void add(DeckSection id, const std::string& text) { add(id, text.data(), text.size()); }
+
+    /**
+     * @brief Writes a temporary file and renames it over imageFile, so a
+     *        process mapping the old image keeps it and never sees half a file.
+     */
+    bool write(const std::string& imageFile, std::string* error = nullptr) const;
+
+private:
+    struct Pending {
+        DeckSection id;
+        uint32_t elementBytes;
+        std::string bytes;
+    };
+    std::vector<Pending> sections_;
+};
+
+const char DeckImage::MAGIC[4] = { 'J', 'T', 'D', 'K' };
+
+namespace deckimage_detail {
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+const size_t ALIGNMENT = 16;
+
+inline size_t alignUp(size_t value) {
+    return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+}  // namespace deckimage_detail
+
+bool DeckImage::open(const std::string& imageFile) {
+    using deckimage_detail::Header;
+    close();
+
+    int fd = ::open(imageFile.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t bytes = static_cast<size_t>(info.st_size);
+    // Shared and read-only: every process opening the image maps the same pages.
+    void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map deck image: " << imageFile << std::endl;
+        return false;
+    }
+
+    const uint8_t* base = static_cast<const uint8_t*>(mapped);
+    const Header* header = reinterpret_cast<const Header*>(base);
+    size_t tableEnd = sizeof(Header) + static_cast<size_t>(header->count) * sizeof(SectionEntry);
+    bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header->version == VERSION && tableEnd <= bytes;
+
+    const SectionEntry* sections = reinterpret_cast<const SectionEntry*>(base + sizeof(Header));
+    for (size_t i = 0; valid && i < header->count; ++i) {
+        valid = sections[i].elementBytes > 0 && sections[i].offset >= tableEnd &&
+                sections[i].offset % deckimage_detail::ALIGNMENT == 0 &&
+                sections[i].offset <= bytes && sections[i].bytes <= bytes - sections[i].offset &&
+                sections[i].bytes % sections[i].elementBytes == 0;
+    }
+    if (!valid) {
+        std::cerr << "Invalid deck image: " << imageFile << std::endl;
+        munmap(mapped, bytes);
+        return false;
+    }
+
+    base_ = base;
+    mappedBytes_ = bytes;
+    sections_ = sections;
+    count_ = header->count;
+    return true;
+}
+
+void DeckImage::close() {
+    if (base_) {
+        munmap(const_cast<uint8_t*>(base_), mappedBytes_);
+    }
+    base_ = nullptr;
+    mappedBytes_ = 0;
+    sections_ = nullptr;
+    count_ = 0;
+}
+
+const DeckImage::SectionEntry* DeckImage::find(DeckSection id) const {
+    for (size_t i = 0; i < count_; ++i) {
+        if (sections_[i].id == static_cast<uint32_t>(id)) return &sections_[i];
+    }
+    return nullptr;
+}
+
+template <typename T>
+FlatArray<T> DeckImage::section(DeckSection id) const {
+    static_assert(std::is_trivially_copyable<T>::value, "deck image sections hold plain structs");
+    const SectionEntry* entry = find(id);
+    if (!entry || entry->elementBytes != sizeof(T)) {
+        return FlatArray<T>();
+    }
+    return FlatArray<T>::view(reinterpret_cast<const T*>(base_ + entry->offset),
+                              static_cast<size_t>(entry->bytes / sizeof(T)));
+}
+
+std::string DeckImage::text(DeckSection id) const {
+    FlatArray<char> chars = section<char>(id);
+    return std::string(chars.begin(), chars.end());
+}
+
+bool DeckImage::validOffsets(const FlatArray<uint32_t>& offsets, size_t count) {
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != count) {
+        return false;
+    }
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        if (offsets[i] < offsets[i - 1]) return false;
+    }
+    return true;
+}
+
+template <typename T>
+void DeckImageWriter::add(DeckSection id, const T* data, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "deck image sections hold plain structs");
+    Pending pending;
+    pending.id = id;
+    pending.elementBytes = static_cast<uint32_t>(sizeof(T));
+    pending.bytes.assign(reinterpret_cast<const char*>(data), count * sizeof(T));
+    sections_.push_back(std::move(pending));
+}
+
+bool DeckImageWriter::write(const std::string& imageFile, std::string* error) const {
+    using deckimage_detail::Header;
+    using deckimage_detail::alignUp;
+    auto fail = [&](const std::string& reason) {
+        if (error) *error = reason;
+        return false;
+    };
+
+    std::vector<DeckImage::SectionEntry> entries(sections_.size());
+    size_t offset = alignUp(sizeof(Header) + entries.size() * sizeof(DeckImage::SectionEntry));
+    for (size_t i = 0; i < sections_.size(); ++i) {
+        entries[i].id = static_cast<uint32_t>(sections_[i].id);
+        entries[i].elementBytes = sections_[i].elementBytes;
+        entries[i].offset = offset;
+        entries[i].bytes = sections_[i].bytes.size();
+        offset = alignUp(offset + sections_[i].bytes.size());
+    }
+
+    Header header;
+    std::memcpy(header.magic, DeckImage::MAGIC, sizeof(DeckImage::MAGIC));
+    header.version = DeckImage::VERSION;
+    header.count = static_cast<uint32_t>(entries.size());
+    header.reserved = 0;
+
+    std::string temp = imageFile + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary);
+        if (!out) return fail("cannot write " + temp);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  static_cast<std::streamsize>(entries.size() * sizeof(DeckImage::SectionEntry)));
+
+        size_t written = sizeof(header) + entries.size() * sizeof(DeckImage::SectionEntry);
+        for (size_t i = 0; i < sections_.size(); ++i) {
+            std::string padding(entries[i].offset - written, '\0');
+            out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+            out.write(sections_[i].bytes.data(), static_cast<std::streamsize>(sections_[i].bytes.size()));
+            written = entries[i].offset + entries[i].bytes;
+        }
+        if (!out) return fail("failed writing " + temp);
+    }
+    if (std::rename(temp.c_str(), imageFile.c_str()) != 0) return fail("cannot rename " + temp);
+    return true;
+}
+
+#endif  // DECKIMAGE_H_
@@ -0,0 +1,207 @@
+#ifndef DECKWATCHER_H_
+#define DECKWATCHER_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+
+#include "deck.h"
+
+/**
+ * @brief Rebuilds a deck when its files change and publishes it without
+ *        stopping anyone quizzing on the old one.
+ *
+ * A thread waits on inotify for the files' directories (editors and
+ * compile_deck replace a file by renaming over it), lets a burst of writes
+ * settle, and runs the loader. A deck it returns is published; nullptr (a
+ * file caught half written, say) keeps the current one.
+ *
+ * Publishing is read-copy-update: the new deck is stored with
+ * std::atomic_store, then version() is bumped. A reader checks version()
+ * against the one it holds, a single atomic load, and only calls current()
+ * when they differ. Whoever still holds the old std::shared_ptr<const Deck>
+ * (a session in the middle of a question) keeps using it; it is freed with
+ * its last reference.
+ *
+ *     DeckWatcher watcher(deck, { "quiz_data.json" }, load);
+ *     watcher.start();
+ *     if (watcher.version() != seen) { seen = watcher.version(); deck = watcher.current(); }
+ */
+class DeckWatcher {
+public:
+    typedef std::function<std::shared_ptr<const Deck>()> Loader;
+    /** Runs on the watcher thread after a deck is published; set it before start(). */
+    typedef std::function<void(uint64_t version, const Deck& deck)> ReloadListener;
+
+    /** Files are given as paths; the ones that do not exist yet are watched for too. */
+    DeckWatcher(std::shared_ptr<const Deck> deck, const std::vector<std::string>& files, Loader loader);
+    ~DeckWatcher() { stop(); }
+
+    DeckWatcher(const DeckWatcher&) = delete;
+    DeckWatcher& operator=(const DeckWatcher&) = delete;
+
+    /** @return False if inotify is unavailable; the deck then stays as it is. */
+    bool start();
+    void stop();
+
+    std::shared_ptr<const Deck> current() const { return std::atomic_load(&deck_); }
+    /** @brief Starts at 0 and goes up by one with every published deck. */
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    /** @brief Runs the loader now, on the calling thread; false if it gave no deck. */
+    bool reload();
+
+    void setReloadListener(ReloadListener listener) { listener_ = std::move(listener); }
+
+    /** How long the files must stay quiet before the deck is rebuilt. */
+    static const int SETTLE_MS = 200;
+
+private:
+    void run();
+    bool matches(int watch, const char* name) const;
+
+    std::shared_ptr<const Deck> deck_;
+    std::atomic<uint64_t> version_;
+    Loader loader_;
+    ReloadListener listener_;
+
+    struct Watched {
+        std::string directory;
+        std::string name;
+        int watch;
+    };
+    std::vector<Watched> files_;
+    int inotifyFd_ = -1;
+    int stopFd_ = -1;
+    std::thread thread_;
+};
+
+const int DeckWatcher::SETTLE_MS;
+
+DeckWatcher::DeckWatcher(std::shared_ptr<const Deck> deck, const std::vector<std::string>& files, Loader loader)
+    : deck_(std::move(deck)),
+      version_(0),
+      loader_(std::move(loader))
+{
+    for (const auto& file : files) {
+        size_t slash = file.find_last_of('/');
+        Watched watched;
+        watched.directory = slash == std::string::npos ? "." : file.substr(0, slash + 1);
+        watched.name = slash == std::string::npos ? file : file.substr(slash + 1);
+        watched.watch = -1;
+        files_.push_back(watched);
+    }
+}
+
+bool DeckWatcher::start() {
+    if (thread_.joinable()) return true;
+
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stopFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd_ < 0 || stopFd_ < 0) {
+        std::cerr << "Deck reload is off: " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    for (auto& watched : files_) {
+        watched.watch = inotify_add_watch(inotifyFd_, watched.directory.c_str(),
+                                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (watched.watch < 0) {
+            std::cerr << "Cannot watch " << watched.directory << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+    // The thread takes no signals; they stay with the threads waiting for them.
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    thread_ = std::thread(&DeckWatcher::run, this);
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    return true;
+}
+
+void DeckWatcher::stop() {
+    if (thread_.joinable()) {
+        uint64_t one = 1;
+        if (write(stopFd_, &one, sizeof(one)) < 0) {
+            std::cerr << "Failed to stop the deck watcher" << std::endl;
+        }
+        thread_.join();
+    }
+    if (inotifyFd_ >= 0) close(inotifyFd_);
+    if (stopFd_ >= 0) close(stopFd_);
+    inotifyFd_ = -1;
+    stopFd_ = -1;
+}
+
+bool DeckWatcher::reload() {
+    std::shared_ptr<const Deck> deck = loader_();
+    if (!deck) {
+        return false;
+    }
+    std::atomic_store(&deck_, deck);
+    uint64_t version = version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (listener_) {
+        listener_(version, *deck);
+    }
+    return true;
+}
+
+bool DeckWatcher::matches(int watch, const char* name) const {
+    for (const auto& watched : files_) {
+        if (watched.watch == watch && watched.name == name) return true;
+    }
+    return false;
+}
+
+void DeckWatcher::run() {
+    // Events are aligned for inotify_event; names follow each one.
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+
+    while (true) {
+        pollfd fds[2] = { { stopFd_, POLLIN, 0 }, { inotifyFd_, POLLIN, 0 } };
+        // Once a file changed, wait for it to settle before rebuilding.
+        int ready = poll(fds, 2, changed ? SETTLE_MS : -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Deck watcher: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        if (fds[0].revents) {
+            return;
+        }
+        if (ready == 0) {
+            changed = false;
+            if (!reload()) {
+                std::cerr << "Deck reload failed; keeping version " << version() << "." << std::endl;
+            }
+            continue;
+        }
+
+        ssize_t bytes;
+        while ((bytes = read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+            for (char* next = buffer; next < buffer + bytes;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(next);
+                if (event->len > 0 && matches(event->wd, event->name)) {
+                    changed = true;
+                }
+                next += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+}
+
+#endif  // DECKWATCHER_H_
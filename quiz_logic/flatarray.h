@@ -0,0 +1,59 @@
+#ifndef FLATARRAY_H_
+#define FLATARRAY_H_
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Array of plain values that either owns them or views memory kept
+ *        alive elsewhere, such as a section of a mapped DeckImage.
+ *
+ * Readers do not care which. edit() hands out the owned vector, copying a
+ * view into it first, so code that builds an index writes to it as before.
+ */
+template <typename T>
+class FlatArray {
+public:
+    typedef const T* const_iterator;
+
+    FlatArray() = default;
+    FlatArray(std::vector<T> values) : owned_(std::move(values)) {}
+
+    /** @brief An array over data it does not own; data must outlive it. */
+    static FlatArray view(const T* data, size_t size) {
+        FlatArray array;
+        array.view_ = data;
+        array.viewSize_ = size;
+        array.viewing_ = true;
+        return array;
+    }
+
+    bool isView() const { return viewing_; }
+    size_t size() const { return viewing_ ? viewSize_ : owned_.size(); }
+    bool empty() const { return size() == 0; }
+    const T* data() const { return viewing_ ? view_ : owned_.data(); }
+
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T& front() const { return data()[0]; }
+    const T& back() const { return data()[size() - 1]; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size(); }
+
+    std::vector<T>& edit() {
+        if (viewing_) {
+            owned_.assign(view_, view_ + viewSize_);
+            view_ = nullptr;
+            viewSize_ = 0;
+            viewing_ = false;
+        }
+        return owned_;
+    }
+
+private:
+    std::vector<T> owned_;
+    const T* view_ = nullptr;
+    size_t viewSize_ = 0;
+    bool viewing_ = false;
+};
+
+#endif  // FLATARRAY_H_
@@ -0,0 +1,119 @@
+#ifndef ITEMKEYS_H_
+#define ITEMKEYS_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "vocab.h"
+#include "vocablist.h"
+#include "flatarray.h"
+#include "deckimage.h"
+
+/**
+ * @brief Finds a deck item by its kanji and hiragana, as Deck::itemKey
+ *        tells items apart.
+ *
+ * The keys are 64-bit FNV-1a hashes kept in one sorted array and binary
+ * searched, so the array is plain data: a deck image stores it and every
+ * index of a mapped deck looks items up in place instead of building a hash
+ * map. An item repeated in the deck is found at its first position.
+ */
+class ItemKeys {
+public:
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    void build(const VocabList& vocabList);
+    /** @brief Keys from their hashes in item order, as rowHashes() gives them. */
+    void assign(const std::vector<uint64_t>& hashes);
+    void clear() { keys_.edit().clear(); }
+    size_t size() const { return keys_.size(); }
+
+    /** @return The item with vocab's kanji and hiragana, or NOT_FOUND. */
+    size_t find(const Vocab& vocab) const;
+    /** @return Every item's hash, in item order. */
+    std::vector<uint64_t> rowHashes() const;
+
+    /** @brief Adds the keys to a deck image; Deck writes them once for every index. */
+    void writeImage(DeckImageWriter& image) const;
+    /** @brief Reads the keys in place; false unless they are sorted and all below itemCount. */
+    bool readImage(const DeckImage& image, size_t itemCount);
+
+    static std::string key(const Vocab& vocab) { return vocab.getKanji() + "\t" + vocab.getHiragana(); }
+    static uint64_t hash(const std::string& key);
+
+private:
+    struct Entry {
+        uint64_t hash;
+        uint32_t item;
+        uint32_t reserved;
+    };
+
+    static bool less(const Entry& a, const Entry& b) {
+        return a.hash < b.hash || (a.hash == b.hash && a.item < b.item);
+    }
+
+    FlatArray<Entry> keys_;  /**< Sorted by hash, then item. */
+};
+
+const size_t ItemKeys::NOT_FOUND;
+
+uint64_t ItemKeys::hash(const std::string& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void ItemKeys::build(const VocabList& vocabList) {
+    std::vector<uint64_t> hashes;
+    hashes.reserve(vocabList.size());
+    for (const auto& vocab : vocabList) {
+        hashes.push_back(hash(key(vocab)));
+    }
+    assign(hashes);
+}
+
+void ItemKeys::assign(const std::vector<uint64_t>& hashes) {
+    std::vector<Entry>& keys = keys_.edit();
+    keys.clear();
+    keys.reserve(hashes.size());
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        keys.push_back({ hashes[i], static_cast<uint32_t>(i), 0 });
+    }
+    std::sort(keys.begin(), keys.end(), less);
+}
+
+size_t ItemKeys::find(const Vocab& vocab) const {
+    Entry wanted = { hash(key(vocab)), 0, 0 };
+    const Entry* it = std::lower_bound(keys_.begin(), keys_.end(), wanted, less);
+    return it != keys_.end() && it->hash == wanted.hash ? it->item : NOT_FOUND;
+}
+
+std::vector<uint64_t> ItemKeys::rowHashes() const {
+    std::vector<uint64_t> hashes(keys_.size());
+    for (const Entry& entry : keys_) {
+        hashes[entry.item] = entry.hash;
+    }
+    return hashes;
+}
+
+void ItemKeys::writeImage(DeckImageWriter& image) const {
+    image.add(DeckSection::ItemKeys, keys_);
+}
+
+bool ItemKeys::readImage(const DeckImage& image, size_t itemCount) {
+    FlatArray<Entry> keys = image.section<Entry>(DeckSection::ItemKeys);
+    if (keys.size() != itemCount) return false;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i].item >= itemCount || (i > 0 && !less(keys[i - 1], keys[i]))) return false;
+    }
+    keys_ = keys;
+    return true;
+}
+
+#endif  // ITEMKEYS_H_
@@ -0,0 +1,326 @@
+#ifndef KANJIINDEX_H_
+#define KANJIINDEX_H_
+
+#include <string>
+#include <vector>
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+
+#include "vocab.h"
+#include "vocablist.h"
+#include "flatarray.h"
+#include "deckimage.h"
+#include "utf8/utf8.h"
+
+/**
+ * @brief Component-bitset index over a KRADFILE radical decomposition.
+ *
+ * Each kanji is reduced to a fixed-width bitset of its components, so the
+ * similarity of two kanji is a handful of AND/OR + popcount instructions.
+ * The top-K most similar kanji for every kanji used by the deck are
+ * precomputed once and drive the confusable-kanji drill.
+ *
+ * The file must be UTF-8 (kradfile-u, or `iconv -f EUC-JP -t UTF-8 kradfile`).
+ * Lines look like "歴 : 厂 止 木"; lines starting with '#' are comments.
+ */
+class KanjiIndex {
+public:
+    static const size_t BITSET_WORDS = 8;  // 512 components, KRADFILE uses ~250
+    static const size_t MAX_COMPONENTS = BITSET_WORDS * 64;
+    static const size_t DEFAULT_TOP_K = 5;
+
+    typedef std::array<uint64_t, BITSET_WORDS> ComponentBits;
+
+    size_t loadKradfile(const std::string& filename);
+    void buildSimilar(const VocabList& vocabList, size_t topK = DEFAULT_TOP_K);
+
+    bool empty() const { return rows_.empty(); }
+    size_t kanjiCount() const { return rows_.size(); }
+    size_t componentCount() const { return componentCount_; }
+
+    double similarity(uint32_t a, uint32_t b) const;
+    double similarity(const std::string& a, const std::string& b) const;
+    std::vector<uint32_t> similar(uint32_t kanji) const;
+    std::vector<std::string> confusableVariants(const std::string& word, size_t maxVariants) const;
+
+    static std::string toUtf8(uint32_t codepoint);
+
+    /** @brief Adds the rows and the similar lists to a deck image. */
+    void writeImage(DeckImageWriter& image) const;
+    /** @brief Reads the rows and the similar lists in place. */
+    bool readImage(const DeckImage& image);
+
+private:
+    /** @brief A kanji and its row; kept sorted by kanji and binary searched. */
+    struct KanjiRef {
+        uint32_t kanji;
+        uint32_t row;
+    };
+
+    static double jaccard(const ComponentBits& a, const ComponentBits& b);
+    /** @return True if refs are sorted by kanji, valid code points, and point at rows below rowCount. */
+    static bool validRefs(const FlatArray<KanjiRef>& refs, size_t rowCount);
+    static bool validCodePoint(uint32_t codepoint) {
+        return codepoint <= 0x10FFFF && (codepoint < 0xD800 || codepoint > 0xDFFF);
+    }
+    static const KanjiRef* lookup(const FlatArray<KanjiRef>& refs, uint32_t kanji);
+    static std::vector<KanjiRef> sortedRefs(const std::unordered_map<uint32_t, uint32_t>& rows);
+
+    size_t componentCount_ = 0;
+    FlatArray<KanjiRef> rowIndex_;       /**< kanji -> row */
+    FlatArray<uint32_t> kanji_;          /**< row -> kanji */
+    FlatArray<ComponentBits> rows_;
+
+    FlatArray<KanjiRef> similarIndex_;   /**< deck kanji -> similar row */
+    FlatArray<uint32_t> similarOffsets_; /**< CSR offsets into similar_ */
+    FlatArray<uint32_t> similar_;        /**< similar kanji, best first */
+};
+
+std::string KanjiIndex::toUtf8(uint32_t codepoint) {
+    std::string out;
+    utf8::append(codepoint, std::back_inserter(out));
+    return out;
+}
+
+size_t KanjiIndex::loadKradfile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open KRADFILE: " << filename << std::endl;
+        return 0;
+    }
+
+    std::unordered_map<uint32_t, uint16_t> components;  // component -> bit
+    std::unordered_map<uint32_t, uint32_t> rowIndex;
+    std::vector<uint32_t>& kanjiList = kanji_.edit();
+    std::vector<ComponentBits>& rows = rows_.edit();
+    kanjiList.clear();
+    rows.clear();
+
+    std::string line;
+    size_t skipped = 0;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (!utf8::is_valid(line.begin(), line.end())) {
+            ++skipped;
+            continue;
+        }
+
+        size_t separator = line.find(" : ");
+        if (separator == std::string::npos) continue;
+
+        std::string head = line.substr(0, separator);
+        if (head.empty()) continue;
+        uint32_t kanji = utf8::peek_next(head.begin(), head.end());
+
+        ComponentBits bits = {};
+        std::stringstream ss(line.substr(separator + 3));
+        std::string part;
+        while (ss >> part) {
+            uint32_t component = utf8::peek_next(part.begin(), part.end());
+            auto it = components.find(component);
+            if (it == components.end()) {
+                if (components.size() >= MAX_COMPONENTS) continue;
+                it = components.emplace(component, static_cast<uint16_t>(components.size())).first;
+            }
+            bits[it->second / 64] |= (1ULL << (it->second % 64));
+        }
+
+        rowIndex[kanji] = static_cast<uint32_t>(rows.size());
+        kanjiList.push_back(kanji);
+        rows.push_back(bits);
+    }
+
+    if (skipped > 0 && rows.empty()) {
+        std::cerr << "KRADFILE is not UTF-8; convert it with iconv -f EUC-JP -t UTF-8." << std::endl;
+    }
+    componentCount_ = components.size();
+    rowIndex_ = sortedRefs(rowIndex);
+    return rows.size();
+}
+
+const KanjiIndex::KanjiRef* KanjiIndex::lookup(const FlatArray<KanjiRef>& refs, uint32_t kanji) {
+    const KanjiRef* it = std::lower_bound(refs.begin(), refs.end(), kanji,
+                                          [](const KanjiRef& ref, uint32_t key) { return ref.kanji < key; });
+    return it != refs.end() && it->kanji == kanji ? it : nullptr;
+}
+
+std::vector<KanjiIndex::KanjiRef> KanjiIndex::sortedRefs(const std::unordered_map<uint32_t, uint32_t>& rows) {
+    std::vector<KanjiRef> refs;
+    refs.reserve(rows.size());
+    for (const auto& entry : rows) {
+        refs.push_back({ entry.first, entry.second });
+    }
+    std::sort(refs.begin(), refs.end(), [](const KanjiRef& a, const KanjiRef& b) { return a.kanji < b.kanji; });
+    return refs;
+}
+
+bool KanjiIndex::validRefs(const FlatArray<KanjiRef>& refs, size_t rowCount) {
+    for (size_t i = 0; i < refs.size(); ++i) {
+        if (refs[i].row >= rowCount || !validCodePoint(refs[i].kanji) ||
+            (i > 0 && refs[i].kanji <= refs[i - 1].kanji)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double KanjiIndex::jaccard(const ComponentBits& a, const ComponentBits& b) {
+    int both = 0;
+    int either = 0;
+    for (size_t i = 0; i < BITSET_WORDS; ++i) {
+        both += __builtin_popcountll(a[i] & b[i]);
+        either += __builtin_popcountll(a[i] | b[i]);
+    }
+    return either == 0 ? 0.0 : static_cast<double>(both) / either;
+}
+
+double KanjiIndex::similarity(uint32_t a, uint32_t b) const {
+    const KanjiRef* ia = lookup(rowIndex_, a);
+    const KanjiRef* ib = lookup(rowIndex_, b);
+    if (!ia || !ib) return 0.0;
+    return jaccard(rows_[ia->row], rows_[ib->row]);
+}
+
+double KanjiIndex::similarity(const std::string& a, const std::string& b) const {
+    if (a.empty() || b.empty()) return 0.0;
+    return similarity(utf8::peek_next(a.begin(), a.end()), utf8::peek_next(b.begin(), b.end()));
+}
+
+void KanjiIndex::buildSimilar(const VocabList& vocabList, size_t topK) {
+    std::unordered_map<uint32_t, uint32_t> similarIndex;
+    std::vector<uint32_t>& similarOffsets = similarOffsets_.edit();
+    std::vector<uint32_t>& similar = similar_.edit();
+    similarOffsets.assign(1, 0);
+    similar.clear();
+
+    std::vector<std::pair<double, uint32_t>> scored;
+    scored.reserve(rows_.size());
+
+    for (const auto& vocab : vocabList) {
+        const std::string word = vocab.getKanji();
+        if (!utf8::is_valid(word.begin(), word.end())) continue;
+
+        for (auto it = word.begin(); it != word.end();) {
+            uint32_t kanji = utf8::next(it, word.end());
+            const KanjiRef* row = lookup(rowIndex_, kanji);
+            if (!row || similarIndex.count(kanji)) continue;
+
+            const ComponentBits& bits = rows_[row->row];
+            scored.clear();
+            for (uint32_t other = 0; other < rows_.size(); ++other) {
+                if (other == row->row) continue;
+                double score = jaccard(bits, rows_[other]);
+                if (score > 0.0) scored.emplace_back(score, other);
+            }
+
+            size_t keep = std::min(topK, scored.size());
+            std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                              [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) {
+                                  return a.first != b.first ? a.first > b.first : a.second < b.second;
+                              });
+
+            similarIndex[kanji] = static_cast<uint32_t>(similarOffsets.size() - 1);
+            for (size_t i = 0; i < keep; ++i) {
+                similar.push_back(kanji_[scored[i].second]);
+            }
+            similarOffsets.push_back(static_cast<uint32_t>(similar.size()));
+        }
+    }
+    similarIndex_ = sortedRefs(similarIndex);
+}
+
+std::vector<uint32_t> KanjiIndex::similar(uint32_t kanji) const {
+    const KanjiRef* ref = lookup(similarIndex_, kanji);
+    if (!ref) return {};
+    return std::vector<uint32_t>(similar_.begin() + similarOffsets_[ref->row],
+                                 similar_.begin() + similarOffsets_[ref->row + 1]);
+}
+
+std::vector<std::string> KanjiIndex::confusableVariants(const std::string& word, size_t maxVariants) const {
+    std::vector<std::string> variants;
+    if (!utf8::is_valid(word.begin(), word.end())) return variants;
+
+    // Round-robin over positions so a two-kanji word gets distractors for both.
+    std::vector<std::pair<size_t, std::vector<uint32_t>>> positions;
+    for (auto it = word.begin(); it != word.end();) {
+        size_t offset = static_cast<size_t>(it - word.begin());
+        std::vector<uint32_t> candidates = similar(utf8::next(it, word.end()));
+        if (!candidates.empty()) positions.emplace_back(offset, candidates);
+    }
+
+    for (size_t rank = 0; variants.size() < maxVariants; ++rank) {
+        bool any = false;
+        for (const auto& position : positions) {
+            if (rank >= position.second.size() || variants.size() >= maxVariants) continue;
+            any = true;
+
+            std::string::const_iterator begin = word.begin() + position.first;
+            std::string::const_iterator end = begin;
+            utf8::next(end, word.end());
+
+            std::string variant = word.substr(0, position.first) + toUtf8(position.second[rank]) +
+                                  std::string(end, word.end());
+            if (variant != word && std::find(variants.begin(), variants.end(), variant) == variants.end()) {
+                variants.push_back(variant);
+            }
+        }
+        if (!any) break;
+    }
+    return variants;
+}
+
+void KanjiIndex::writeImage(DeckImageWriter& image) const {
+    uint32_t components = static_cast<uint32_t>(componentCount_);
+    image.add(DeckSection::KanjiComponents, &components, 1);
+    image.add(DeckSection::KanjiCodes, kanji_);
+    image.add(DeckSection::KanjiRows, rows_);
+    image.add(DeckSection::KanjiRowIndex, rowIndex_);
+    image.add(DeckSection::KanjiSimilarIndex, similarIndex_);
+    image.add(DeckSection::KanjiSimilarOffsets, similarOffsets_);
+    image.add(DeckSection::KanjiSimilar, similar_);
+}
+
+bool KanjiIndex::readImage(const DeckImage& image) {
+    FlatArray<uint32_t> kanji = image.section<uint32_t>(DeckSection::KanjiCodes);
+    FlatArray<ComponentBits> rows = image.section<ComponentBits>(DeckSection::KanjiRows);
+    FlatArray<KanjiRef> rowIndex = image.section<KanjiRef>(DeckSection::KanjiRowIndex);
+    FlatArray<KanjiRef> similarIndex = image.section<KanjiRef>(DeckSection::KanjiSimilarIndex);
+    FlatArray<uint32_t> similarOffsets = image.section<uint32_t>(DeckSection::KanjiSimilarOffsets);
+    FlatArray<uint32_t> similar = image.section<uint32_t>(DeckSection::KanjiSimilar);
+    FlatArray<uint32_t> components = image.section<uint32_t>(DeckSection::KanjiComponents);
+
+    // Lookups binary search the refs and follow them into the rows and the
+    // similar lists, and similar kanji are encoded back to UTF-8.
+    if (kanji.size() != rows.size() || rowIndex.size() > rows.size() || components.size() > 1 ||
+        (!components.empty() && components[0] > MAX_COMPONENTS) || !validRefs(rowIndex, rows.size())) {
+        return false;
+    }
+    if (!similarIndex.empty() || !similarOffsets.empty()) {
+        if (similarOffsets.size() != similarIndex.size() + 1 || !DeckImage::validOffsets(similarOffsets, similar.size()) ||
+            !validRefs(similarIndex, similarIndex.size())) {
+            return false;
+        }
+    }
+    for (uint32_t codepoint : kanji) {
+        if (!validCodePoint(codepoint)) return false;
+    }
+    for (uint32_t codepoint : similar) {
+        if (!validCodePoint(codepoint)) return false;
+    }
+
+    componentCount_ = components.empty() ? 0 : components[0];
+    kanji_ = kanji;
+    rows_ = rows;
+    rowIndex_ = rowIndex;
+    similarIndex_ = similarIndex;
+    similarOffsets_ = similarOffsets;
+    similar_ = similar;
+    return true;
+}
+
+#endif  // KANJIINDEX_H_
@@ -5,12 +5,18 @@
 #include <cctype>
 
 #include "vocab.h"
+#include "quizsession.h"
 
 class QuestionHandler {
 public:
     void askQuestion(const Vocab& vocab, const std::string& questionFormat);
     bool processAnswer(const Vocab& vocab, const std::string& userAnswer, const std::string& correctAnswer);
     std::string getCorrectAnswer(const Vocab& vocab, const std::string& questionFormat);
+    /** True once the learner answered "q" or "quit"; the caller decides how to stop. */
+    bool quitRequested() const { return quitRequested_; }
+
+private:
+    bool quitRequested_ = false;
 };
 
 void QuestionHandler::askQuestion(const Vocab& vocab, const std::string& questionFormat) {
@@ -18,15 +24,16 @@ void QuestionHandler::askQuestion(const Vocab& vocab, const std::string& questio
 }
 
 bool QuestionHandler::processAnswer(const Vocab& vocab, const std::string& userAnswer, const std::string& correctAnswer) {
-    std::string lowerAndTrimmedAnswer = toLowercaseAndTrim(userAnswer);
+    std::string lowerAndTrimmedAnswer = QuizSession::toLowercaseAndTrim(userAnswer);
 
     // Check if the user wants to quit
     if (lowerAndTrimmedAnswer == "q" || lowerAndTrimmedAnswer == "quit") {
         std::cout << "Quiz terminated by the user." << std::endl;
-        exit(0);  // Exit the program
+        quitRequested_ = true;
+        return false;
     }
 
-    bool isCorrect = checkAnswer(lowerAndTrimmedAnswer, correctAnswer);
+    bool isCorrect = QuizSession::answersMatch(lowerAndTrimmedAnswer, correctAnswer);
 
     if (isCorrect) {
         std::cout << "Correct!" << std::endl;
@@ -46,6 +53,8 @@ std::string QuestionHandler::getCorrectAnswer(const Vocab& vocab, const std::str
         return vocab.getRomaji();
     else if (questionFormat == "Translate the following English word to hiragana: ")
         return vocab.getHiragana();
+    else if (questionFormat == "Fill in the blank with the missing word in hiragana: ")
+        return vocab.getHiragana();
     else
         return "Invalid test type.";
 }
\ No newline at end of file
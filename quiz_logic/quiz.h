@@ -7,71 +7,128 @@
 #include <random>
 #include <algorithm>
 #include <cctype>
-#include <regex>
 #include <chrono>
 #include <stdexcept>
 #include <limits>
 #include <iomanip>
 #include <map>
+#include <memory>
+#include <functional>
 
 #include "ebisu.h"
 #include "vocab.h"
+#include "deck.h"
+#include "quizsession.h"
+#include "deckwatcher.h"
 #include "utf8/utf8.h"
 
+/**
+ * @brief The terminal front end: reads the mode and the answers from
+ *        std::cin, prints questions and results, and keeps quiz_state.json.
+ *        Questions and grading come from a QuizSession.
+ */
 class Quiz {
 private:
-    std::vector<Vocab> vocabList_;
+    std::shared_ptr<const Deck> deck_;
+    Deck* ownDeck_;  // deck_ when this quiz made it and may change it; nullptr for a published deck
+    bool quiet_ = false;  // Set while building a deck in the background: only errors are printed
     std::random_device rd_;
     std::mt19937 generator_;
     std::uniform_int_distribution<int> distribution_;
-    Ebisu ebisuModel_;
     std::string testType_;
     int NUM_QUESTIONS;  // Updated to a non-constant member variable
-    size_t totalQuestions_ = 0;
-    int correctAnswers_ = 0;
+    LearnerState learner_;  // Between runs; a running session holds the live copy
+    std::unique_ptr<QuizSession> session_;
+    std::unique_ptr<DeckWatcher> watcher_;  // Set by watchDeck()
+    uint64_t deckVersion_ = 0;              // Last version of watcher_ taken up
     static const char QUIZ_STATE_FILE[];
-    std::map<const Vocab*, std::chrono::steady_clock::time_point> lastQuestionTimes_;
-
+    static const char SENTENCE_CORPUS_FILE[];
+    static const char SENTENCE_INDEX_FILE[];
+    static const char KRADFILE[];
 
 public:
+    /** Receives the next questions (soonest first) each time one is drawn. */
+    typedef QuizSession::UpcomingListener UpcomingListener;
+    /** Runs right before a question is shown, e.g. to play its audio. */
+    typedef std::function<void(const Vocab&)> QuestionHook;
+    /** Plays a word's audio at the given speed (1.0 = as recorded); false if none could be played. */
+    typedef std::function<bool(const Vocab&, double)> AudioHook;
+
+    /** Speed of the "s" replay in listening comprehension. */
+    static const double SLOW_REPLAY_SPEED;
+
     Quiz()
-        : rd_(),
+        : deck_(),
+          ownDeck_(nullptr),
+          rd_(),
           generator_(rd_()),
           distribution_(),
-          ebisuModel_(),
           testType_(),
-          NUM_QUESTIONS(10),  // Initialized directly in the constructor
-          totalQuestions_(0),
-          correctAnswers_(0)
-    {}
+          NUM_QUESTIONS(10)  // Initialized directly in the constructor
+    {
+        std::shared_ptr<Deck> deck = std::make_shared<Deck>();
+        ownDeck_ = deck.get();
+        deck_ = deck;
+    }
 
     explicit Quiz(const std::vector<Vocab>& vocabList)
-        : vocabList_(vocabList),
+        : deck_(),
+          ownDeck_(nullptr),
           rd_(),
           generator_(rd_()),
           distribution_(),
-          ebisuModel_(),
           testType_(),
-          NUM_QUESTIONS(10),  // Initialized directly in the constructor
-          totalQuestions_(0),
-          correctAnswers_(0)
-    {}
+          NUM_QUESTIONS(10)  // Initialized directly in the constructor
+    {
+        std::shared_ptr<Deck> deck = std::make_shared<Deck>();
+        deck->items = vocabList;
+        ownDeck_ = deck.get();
+        deck_ = deck;
+    }
 
-    void addVocab(const Vocab& vocab) { vocabList_.push_back(vocab); }
-    bool isFinished() const { return totalQuestions_ == vocabList_.size(); }
+    void addVocab(const Vocab& vocab) { editDeck().items.push_back(vocab); }
+    bool isFinished() const { return learner().totalQuestions == deck_->items.size(); }
     bool checkAnswer(const Vocab& vocab, const std::string& answer);
     int getTotalQuestions() const;
     int getCorrectAnswers() const;
     bool loadQuiz(const std::string& filename);
     void startQuiz();
-    void askQuestion(const Vocab& vocab);
-    void processAnswer(const Vocab& vocab, const std::string& userAnswer, const std::chrono::steady_clock::time_point& now);
+    bool askQuestion();
+    bool processAnswer(const AnswerResult& result);
 
     Vocab getRandomVocab();
+    size_t nextQuestionIndex(const std::vector<size_t>& candidates, size_t remaining);
+    void setUpcomingListener(UpcomingListener listener, size_t lookahead = 3);
+    void setQuestionHook(QuestionHook hook) { questionHook_ = std::move(hook); }
+    void setAudioHook(AudioHook hook) { audioHook_ = std::move(hook); }
     void printStatistics() const;
     bool validateAnswer(const std::string& answer);
     void saveQuizState();
     void loadQuizState();
+    bool loadSentenceIndex(const std::string& corpusFile);
+    bool loadKanjiIndex(const std::string& kradFile);
+
+    /** @return The deck as it stands; sessions started from now on share it. */
+    std::shared_ptr<const Deck> deck() const { return deck_; }
+
+    /**
+     * @brief Builds a deck from a JSON file (or the image compiled from it)
+     *        or from a deck image, with whichever indices have their files.
+     * @param quiet Print errors only, e.g. when rebuilding behind a question prompt.
+     * @return nullptr if the deck cannot be read or has no items.
+     */
+    static std::shared_ptr<const Deck> buildDeck(const std::string& deckFile,
+                                                 const std::string& corpusFile = SENTENCE_CORPUS_FILE,
+                                                 const std::string& kradFile = KRADFILE,
+                                                 bool quiet = false);
+
+    /**
+     * @brief Rebuilds the deck in the background whenever deckFile, its image
+     *        or the index files change (see DeckWatcher). The quiz takes the
+     *        new deck up between questions; the learner's history follows
+     *        the items by kanji and hiragana.
+     */
+    bool watchDeck(const std::string& deckFile);
 
     // Needed for unit test otherwise it's protected class
     // std::string testType_;
@@ -89,12 +146,64 @@ public:
     void setLastQuestionTime(Vocab& vocab, const std::chrono::steady_clock::time_point& time);
 
 private:
-
+    Deck& editDeck();
+    QuizSession& session();
+    std::string prepareDeck();
+    void adoptReloadedDeck();
+    const LearnerState& learner() const { return session_ ? session_->learner() : learner_; }
+    LearnerState& learner() { return session_ ? session_->learner() : learner_; }
+
+    UpcomingListener upcomingListener_;
+    size_t lookahead_ = 0;
+    QuestionHook questionHook_;
+    AudioHook audioHook_;
 };
 
 const char Quiz::QUIZ_STATE_FILE[] = "quiz_state.json";
+const char Quiz::SENTENCE_CORPUS_FILE[] = "sentences.tsv";
+const char Quiz::SENTENCE_INDEX_FILE[] = "quiz_sentences.json";
+const char Quiz::KRADFILE[] = "kradfile-u";
+const double Quiz::SLOW_REPLAY_SPEED = 0.75;
+
+Deck& Quiz::editDeck() {
+    // A running session reads the deck; it ends here, and a deck still
+    // shared with anyone else, or published by the watcher, is copied
+    // instead of changed under them.
+    if (session_) {
+        learner_ = session_->learner();
+        session_.reset();
+    }
+    if (!ownDeck_ || deck_.use_count() > 1) {
+        std::shared_ptr<Deck> copy = std::make_shared<Deck>(*deck_);
+        ownDeck_ = copy.get();
+        deck_ = copy;
+    }
+    return *ownDeck_;
+}
+
+QuizSession& Quiz::session() {
+    if (!session_) {
+        session_.reset(new QuizSession(deck_, testType_, NUM_QUESTIONS, learner_, generator_()));
+        session_->setUpcomingListener(upcomingListener_, lookahead_);
+    }
+    return *session_;
+}
 
 bool Quiz::loadQuiz(const std::string& filename) {
+    // A compiled image of the deck (./compile_deck) is mapped instead of parsing the JSON.
+    const std::string imageFile = Deck::imageFileFor(filename);
+    if (deck_->items.empty() && Deck::imageIsCurrent(imageFile, filename)) {
+        std::shared_ptr<Deck> mapped = Deck::open(imageFile);
+        if (mapped) {
+            editDeck();
+            ownDeck_ = mapped.get();
+            deck_ = mapped;
+            distribution_ = std::uniform_int_distribution<int>(0, static_cast<int>(deck_->items.size()) - 1);
+            if (!quiet_) std::cout << "Loaded deck image: " << imageFile << std::endl;
+            return true;
+        }
+    }
+
     std::ifstream file(filename);
     if (!file) {
         std::cerr << "Failed to open file: " << filename << std::endl;
@@ -104,7 +213,7 @@ bool Quiz::loadQuiz(const std::string& filename) {
     nlohmann::json jsonData;
     try {
         file >> jsonData;
-        std::cout << "Loaded JSON data: "<< std::endl;
+        if (!quiet_) std::cout << "Loaded JSON data: "<< std::endl;
     #ifndef DEBUG
         // std::cout << "Loaded JSON data: " << jsonData.dump(4) << std::endl;
     #endif
@@ -113,11 +222,12 @@ bool Quiz::loadQuiz(const std::string& filename) {
         return false;
     }
 
+    Deck& deck = editDeck();
     if (jsonData.is_array()) {
         for (const auto& vocabData : jsonData) {
             try {
                 Vocab vocab(vocabData);
-                vocabList_.push_back(vocab);
+                deck.items.push_back(vocab);
             } catch (const std::exception& e) {
                 std::cerr << "Failed to parse vocab data: " << e.what() << std::endl;
             }
@@ -127,27 +237,29 @@ bool Quiz::loadQuiz(const std::string& filename) {
         return false;
     }
 
-    distribution_ = std::uniform_int_distribution<int>(0, static_cast<int>(vocabList_.size()) - 1);
+    distribution_ = std::uniform_int_distribution<int>(0, static_cast<int>(deck.items.size()) - 1);
+    deck.conjugations.build(deck.items);
     return true;
 }
 
 void Quiz::saveQuizState() {
+    const LearnerState& learner = this->learner();
     nlohmann::json quizState;
-    quizState["total_questions"] = totalQuestions_;
-    quizState["correct_answers"] = correctAnswers_;
+    quizState["total_questions"] = learner.totalQuestions;
+    quizState["correct_answers"] = learner.correctAnswers;
     quizState["vocab_list"] = nlohmann::json::array();
 
-    for (const auto& vocab : vocabList_) {
-        nlohmann::json vocabData = vocab.toJson();
-        if (vocab.getLastQuestionTime() == std::chrono::steady_clock::time_point()) {
+    for (size_t i = 0; i < deck_->items.size(); ++i) {
+        nlohmann::json vocabData = deck_->items[i].toJson();
+        if (learner.lastAskedAt(i) == std::chrono::steady_clock::time_point()) {
             vocabData["last_question_time"] = 0; // Indicate that last question time is not available
         } else {
-            vocabData["last_question_time"] = vocab.getLastQuestionTime().time_since_epoch().count();
+            vocabData["last_question_time"] = learner.lastAskedAt(i).time_since_epoch().count();
         }
         quizState["vocab_list"].push_back(vocabData);
     }
 
-    quizState["ebisu_model"] = ebisuModel_.toJson();
+    quizState["ebisu_model"] = learner.model.toJson();
 
     try {
         std::ofstream file(QUIZ_STATE_FILE);
@@ -175,10 +287,15 @@ void Quiz::loadQuizState() {
             quizData.contains("correct_answers") &&
             quizData.contains("vocab_list") &&
             quizData.contains("ebisu_model")) {
-            totalQuestions_ = quizData["total_questions"];
-            correctAnswers_ = quizData["correct_answers"];
+            if (session_) {
+                session_.reset();
+            }
+            learner_ = LearnerState();
+            learner_.totalQuestions = quizData["total_questions"];
+            learner_.correctAnswers = quizData["correct_answers"];
 
-            vocabList_.clear();
+            std::vector<Vocab> saved;
+            std::vector<std::chrono::steady_clock::time_point> savedTimes;
             for (const auto& vocabData : quizData["vocab_list"]) {
                 Vocab vocab(vocabData);
                 // Set the last question time for the vocabulary from the loaded JSON data
@@ -189,10 +306,34 @@ void Quiz::loadQuizState() {
                     );
                 }
                 vocab.setLastQuestionTime(lastQuestionTime);
-                vocabList_.push_back(vocab);
+                saved.push_back(vocab);
+                savedTimes.push_back(lastQuestionTime);
             }
 
-            ebisuModel_.fromJson(quizData["ebisu_model"]);
+            if (deck_->items.empty()) {
+                // No deck loaded: the saved list is the deck.
+                Deck& deck = editDeck();
+                deck.items = saved;
+                deck.conjugations.build(deck.items);
+                for (size_t i = 0; i < saved.size(); ++i) {
+                    learner_.setLastAsked(i, savedTimes[i]);
+                }
+            } else {
+                // Keep the loaded deck (it may be a shared image); only the
+                // learner's times come from the file, matched by item key.
+                std::map<std::string, size_t> items;
+                for (size_t i = 0; i < deck_->items.size(); ++i) {
+                    items.emplace(Deck::itemKey(deck_->items[i]), i);
+                }
+                for (size_t i = 0; i < saved.size(); ++i) {
+                    auto it = items.find(Deck::itemKey(saved[i]));
+                    if (it != items.end()) {
+                        learner_.setLastAsked(it->second, savedTimes[i]);
+                    }
+                }
+            }
+
+            learner_.model.fromJson(quizData["ebisu_model"]);
         }
     }
     catch (const std::exception& e) {
@@ -200,26 +341,206 @@ void Quiz::loadQuizState() {
     }
 }
 
+bool Quiz::loadSentenceIndex(const std::string& corpusFile) {
+    Deck& deck = editDeck();
+    const std::string fingerprint = SentenceIndex::deckFingerprint(deck.items);
+
+    // Reuse the compiled postings when they were built for this deck.
+    std::ifstream indexFile(SENTENCE_INDEX_FILE);
+    if (indexFile) {
+        try {
+            nlohmann::json jsonIndex;
+            indexFile >> jsonIndex;
+            SentenceIndex cached;
+            if (!cached.fromJson(jsonIndex)) {
+                std::cerr << "Ignoring inconsistent sentence index: " << SENTENCE_INDEX_FILE << std::endl;
+            } else if (cached.getDeckFingerprint() == fingerprint && !cached.empty()) {
+                deck.sentences = cached;
+                return true;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to load sentence index: " << e.what() << std::endl;
+        }
+    }
+
+    if (deck.sentences.build(deck.items, corpusFile) == 0) {
+        return false;
+    }
+
+    try {
+        std::ofstream file(SENTENCE_INDEX_FILE);
+        file << deck.sentences.toJson() << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unable to save sentence index: " << e.what() << std::endl;
+    }
+    return true;
+}
+
+bool Quiz::loadKanjiIndex(const std::string& kradFile) {
+    Deck& deck = editDeck();
+    if (deck.kanji.loadKradfile(kradFile) == 0) {
+        return false;
+    }
+    deck.kanji.buildSimilar(deck.items);
+    return true;
+}
+
+std::shared_ptr<const Deck> Quiz::buildDeck(const std::string& deckFile, const std::string& corpusFile,
+                                            const std::string& kradFile, bool quiet) {
+    // A compiled image (./compile_deck) already carries its indices and is mapped as is.
+    const std::string extension = Deck::IMAGE_EXTENSION;
+    if (deckFile.size() > extension.size() &&
+        deckFile.compare(deckFile.size() - extension.size(), extension.size(), extension) == 0) {
+        std::shared_ptr<const Deck> mapped = Deck::open(deckFile);
+        if (!mapped) {
+            std::cerr << "Failed to open deck image: " << deckFile << std::endl;
+        }
+        return mapped;
+    }
+
+    Quiz loader;
+    loader.quiet_ = quiet;
+    if (!loader.loadQuiz(deckFile)) {
+        return nullptr;
+    }
+    if (loader.deck_->items.empty()) {
+        std::cerr << "No vocabularies in " << deckFile << std::endl;
+        return nullptr;
+    }
+    if (!loader.deck_->image) {
+        if (!loader.loadSentenceIndex(corpusFile) && !quiet) {
+            std::cerr << "No example sentences; Fill in the Blank is unavailable." << std::endl;
+        }
+        if (!loader.loadKanjiIndex(kradFile) && !quiet) {
+            std::cerr << "No kanji decomposition data; Confusable Kanji is unavailable." << std::endl;
+        }
+    }
+    return loader.deck();
+}
+
+bool Quiz::watchDeck(const std::string& deckFile) {
+    std::vector<std::string> files = { deckFile, Deck::imageFileFor(deckFile), SENTENCE_CORPUS_FILE, KRADFILE };
+    watcher_.reset(new DeckWatcher(deck_, files, [deckFile]() {
+        // Runs on the watcher thread, behind a question prompt.
+        return buildDeck(deckFile, SENTENCE_CORPUS_FILE, KRADFILE, true);
+    }));
+    deckVersion_ = watcher_->version();
+    return watcher_->start();
+}
+
+void Quiz::adoptReloadedDeck() {
+    if (!watcher_ || watcher_->version() == deckVersion_) {
+        return;
+    }
+    deckVersion_ = watcher_->version();
+    std::shared_ptr<const Deck> latest = watcher_->current();
+
+    // The running session keeps the old deck until the new one is ready;
+    // if this mode cannot run on the new deck, it simply carries on.
+    std::shared_ptr<const Deck> previous = deck_;
+    Deck* previousOwn = ownDeck_;
+    std::unique_ptr<QuizSession> running = std::move(session_);
+    LearnerState learner = running ? running->learner() : learner_;
+    learner.remap(*previous, *latest);
+
+    // The published deck is used as is; editDeck() copies it if it has to change.
+    deck_ = latest;
+    ownDeck_ = nullptr;
+    learner_ = learner;
+    std::string reason;
+    if (running) {
+        reason = prepareDeck();
+        if (reason.empty()) {
+            session_.reset(new QuizSession(deck_, testType_, running->questionCount() - running->asked(),
+                                           learner_, generator_()));
+            session_->setUpcomingListener(upcomingListener_, lookahead_);
+            reason = session_->error();
+        }
+    }
+    if (!reason.empty()) {
+        std::cout << "The deck changed on disk; keeping the current one. " << reason << std::endl;
+        deck_ = previous;
+        ownDeck_ = previousOwn;
+        learner_ = running->learner();
+        session_ = std::move(running);
+        return;
+    }
+    distribution_ = std::uniform_int_distribution<int>(0, static_cast<int>(deck_->items.size()) - 1);
+    std::cout << "Deck reloaded: " << deck_->items.size() << " items." << std::endl;
+}
+
+std::string Quiz::prepareDeck() {
+    // Loading the indices is file I/O, so it happens here, before the session starts.
+    if (testType_ == "Fill in the Blank") {
+        if (deck_->sentences.empty() && !loadSentenceIndex(SENTENCE_CORPUS_FILE)) {
+            return "No example sentences available.";
+        }
+    } else if (testType_ == "Confusable Kanji") {
+        if (deck_->kanji.empty() && !loadKanjiIndex(KRADFILE)) {
+            return "No kanji decomposition data available.";
+        }
+    } else if (testType_ == "Conjugation") {
+        if (deck_->conjugations.empty()) {
+            editDeck().conjugations.build(deck_->items);
+        }
+    }
+    return std::string();
+}
+
 void Quiz::startQuiz() {
     selectTestType();
     if (testType_.empty()) {
         std::cout << "Invalid test type. Quiz aborted." << std::endl;
         return;
     }
+    if (testType_ == "Listening Comprehension" && !audioHook_) {
+        std::cout << "Listening comprehension needs audio (run ./main --listen). Quiz aborted." << std::endl;
+        return;
+    }
 
-    for (int i = 0; i < NUM_QUESTIONS; ++i) {
-        Vocab vocab = getRandomVocab();
-        askQuestion(vocab);
+    adoptReloadedDeck();
+    std::string reason = prepareDeck();
+    if (!reason.empty()) {
+        std::cout << reason << " Quiz aborted." << std::endl;
+        return;
+    }
+
+    if (session_) {
+        learner_ = session_->learner();
+        session_.reset();
+    }
+    if (!session().error().empty()) {
+        std::cout << session_->error() << " Quiz aborted." << std::endl;
+        return;
+    }
+
+    while (!session_->finished()) {
+        // A deck reloaded meanwhile is taken up between questions, never during one.
+        adoptReloadedDeck();
+        if (!askQuestion()) {
+            break;
+        }
+    }
+}
+
+size_t Quiz::nextQuestionIndex(const std::vector<size_t>& candidates, size_t remaining) {
+    return session().drawIndex(candidates, remaining);
+}
+
+void Quiz::setUpcomingListener(UpcomingListener listener, size_t lookahead) {
+    upcomingListener_ = std::move(listener);
+    lookahead_ = upcomingListener_ ? lookahead : 0;
+    if (session_) {
+        session_->setUpcomingListener(upcomingListener_, lookahead_);
     }
 }
 
 void Quiz::selectTestType() {
-    std::map<int, std::string> quizTypeMap = {
-        {1, "Kanji to Hiragana"},
-        {2, "Hiragana to English"},
-        {3, "Hiragana to Romaji"},
-        {4, "English to Hiragana"}
-    };
+    std::map<int, std::string> quizTypeMap;
+    for (size_t i = 0; i < QuizSession::testTypes().size(); ++i) {
+        quizTypeMap[static_cast<int>(i) + 1] = QuizSession::testTypes()[i];
+    }
 
     std::cout << "Select the quiz type (Enter 'q' or 'quit' to exit):" << std::endl;
     for (const auto& quizType : quizTypeMap) {
@@ -263,125 +584,106 @@ void Quiz::selectTestType() {
     std::cerr << "Too many invalid attempts. Quiz aborted." << std::endl;
 }
 
-void Quiz::askQuestion(const Vocab& vocab) {
+bool Quiz::askQuestion() {
+    auto now = std::chrono::steady_clock::now();
+    const SessionQuestion& question = session().nextQuestion(now);
+    if (question.prompt.empty()) {
+        std::cout << question.skipReason << std::endl;
+        return true;
+    }
+    const Vocab vocab = deck_->items[question.item];
+
     std::cout << "-----------------------------" << std::endl;
-    std::cout << "Question " << totalQuestions_ + 1 << ":" << std::endl;
+    std::cout << "Question " << learner().totalQuestions + 1 << ":" << std::endl;
 
-    std::string question;
-    std::string correctAnswer;
+    // Listening questions are the audio itself; the others may be read aloud.
+    if (question.listening) {
+        if (!audioHook_ || !audioHook_(vocab, 1.0)) {
+            std::cout << "No audio for " << vocab.getKanji() << "." << std::endl;
+        }
+        std::cout << question.prompt << std::endl;
+        std::cout << "(Enter 'r' to hear it again, 's' to hear it slower.)" << std::endl;
+    } else {
+        if (questionHook_) {
+            questionHook_(vocab);
+        }
+        std::cout << question.prompt << std::endl;
+    }
 
-    // Get the last question time for the current vocab
-    std::chrono::steady_clock::time_point lastQuestionTime = getLastQuestionTime(vocab);
+    AnswerResult result;
+    do {
+        std::string userAnswer = getUserAnswer();
+        if (question.listening && audioHook_ && (userAnswer == "r" || userAnswer == "s")) {
+            audioHook_(vocab, userAnswer == "s" ? SLOW_REPLAY_SPEED : 1.0);
+            continue;
+        }
+        result = session_->submitAnswer(userAnswer);
+        if (!processAnswer(result)) {
+            return false;
+        }
+    } while (session_->pending());
 
-    // Calculate the elapsed time since the last question in minutes
-    auto now = std::chrono::steady_clock::now();
-    auto elapsedMinutes = std::chrono::duration_cast<std::chrono::minutes>(now - lastQuestionTime).count();
-
-    // Use the elapsed time to predict recall
-    double predictedRecall = ebisuModel_.predictRecall(elapsedMinutes);
-
-    if (testType_ == "Kanji to Hiragana") {
-        question = "What is the hiragana reading of the following kanji? " + vocab.getKanji();
-        correctAnswer = vocab.getHiragana();
-    } else if (testType_ == "Hiragana to English") {
-        question = "What is the English meaning of the following hiragana? " + vocab.getHiragana();
-        correctAnswer = vocab.correctAnswer();
-    } else if (testType_ == "Hiragana to Romaji") {
-        question = "What is the romaji reading of the following hiragana? " + vocab.getHiragana();
-        correctAnswer = vocab.getRomaji();
-    } else if (testType_ == "English to Hiragana") {
-        question = "What is the hiragana reading of the following English word? " + vocab.correctAnswer();
-        correctAnswer = vocab.getHiragana();
-    }
-
-    std::cout << question << std::endl;
-    std::string userAnswer = getUserAnswer();
-    processAnswer(vocab, userAnswer, now); // Pass the current time as an argument
-    std::cout << "Correct answer: " << correctAnswer << std::endl;
-    std::cout << "Predicted Recall: " << std::fixed << std::setprecision(2) << (predictedRecall * 100) << "%" << std::endl;
+    std::cout << "Correct answer: " << question.correctAnswer << std::endl;
+    std::cout << "Predicted Recall: " << std::fixed << std::setprecision(2) << (question.predictedRecall * 100) << "%" << std::endl;
 
     // Display the last question time for the current vocab
-    if (lastQuestionTime == std::chrono::steady_clock::time_point()) {
+    if (question.lastAsked == std::chrono::steady_clock::time_point()) {
         std::cout << "Last question time: Not available" << std::endl;
     } else {
-        std::chrono::system_clock::time_point sysTimePoint = std::chrono::time_point_cast<std::chrono::system_clock::duration>(lastQuestionTime - std::chrono::steady_clock::now() + std::chrono::system_clock::now());
+        std::chrono::system_clock::time_point sysTimePoint = std::chrono::time_point_cast<std::chrono::system_clock::duration>(question.lastAsked - std::chrono::steady_clock::now() + std::chrono::system_clock::now());
         std::time_t lastQuestionTimeT = std::chrono::system_clock::to_time_t(sysTimePoint);
 
         std::cout << "Last question time: " << std::ctime(&lastQuestionTimeT);
     }
 
     std::cout << "-----------------------------" << std::endl;
-
-    // Update the last question time for the current vocab
-    setLastQuestionTime(const_cast<Vocab&>(vocab), now);
     saveQuizState();
+    return true;
 }
 
-void Quiz::processAnswer(const Vocab& vocab, const std::string& userAnswer, const std::chrono::steady_clock::time_point& now) {
-    std::string trimmedAnswer = trim(userAnswer);
-
-    if (trimmedAnswer == "q" || trimmedAnswer == "quit") {
+bool Quiz::processAnswer(const AnswerResult& result) {
+    switch (result.status) {
+    case AnswerStatus::Quit:
         std::cout << "Quiz aborted. Goodbye!" << std::endl;
-        // Perform any necessary cleanup or termination steps
-        saveQuizState();
-        printStatistics();
-        exit(0);
-    }
-
-    if (trimmedAnswer.empty()) {
-        std::cout << "Please enter an answer." << std::endl;
-        askQuestion(vocab);  // Ask the question again
-        return;
-    }
-
-    if (validateAnswer(trimmedAnswer)) {
-        std::string correctAnswer = getCorrectAnswer(vocab);
-
-        if (checkAnswer(trimmedAnswer, correctAnswer)) {
-            std::cout << "Correct!" << std::endl;
-            ++correctAnswers_;
-        } else {
-            std::cout << "Incorrect." << std::endl;
-        }
-
-        // Calculate the elapsed time since the last question in minutes
-        auto elapsedMinutes = std::chrono::duration_cast<std::chrono::minutes>(now - getLastQuestionTime(vocab)).count();
-        ebisuModel_.updateRecall(correctAnswers_, totalQuestions_, elapsedMinutes);
-
-        setLastQuestionTime(const_cast<Vocab&>(vocab), now);
-        saveQuizState();
-
-        // Increment the total questions counter
-        ++totalQuestions_;
-    } else {
-        askQuestion(vocab);  // Ask the question again
+        return false;
+    case AnswerStatus::Invalid:
+        std::cout << result.message << std::endl;
+        return true;
+    case AnswerStatus::Correct:
+        std::cout << "Correct!" << std::endl;
+        return true;
+    case AnswerStatus::Incorrect:
+        std::cout << "Incorrect." << std::endl;
+        return true;
     }
+    return true;
 }
 
 Vocab Quiz::getRandomVocab() {
-    if (vocabList_.empty()) {
+    if (deck_->items.empty()) {
         throw std::runtime_error("No vocabularies loaded.");
     }
 
     int randomIndex = distribution_(generator_);
-    return vocabList_[randomIndex];
+    return deck_->items[randomIndex];
 }
 
 void Quiz::printStatistics() const {
+    const LearnerState& learner = this->learner();
     std::cout << "Quiz Statistics:" << std::endl;
     std::cout << "-----------------------------" << std::endl;
-    std::cout << "Total Questions: " << totalQuestions_ << std::endl;
-    std::cout << "Correct Answers: " << correctAnswers_ << std::endl;
+    std::cout << "Total Questions: " << learner.totalQuestions << std::endl;
+    std::cout << "Correct Answers: " << learner.correctAnswers << std::endl;
+
+    if (learner.totalQuestions > 0) {
+        double successRate = static_cast<double>(learner.correctAnswers) / learner.totalQuestions;
 
-    if (totalQuestions_ > 0) {
-        double successRate = static_cast<double>(correctAnswers_) / totalQuestions_;
-        
         // Calculate the elapsed time since the last question in minutes
         auto now = std::chrono::steady_clock::now();
-        auto elapsedMinutes = std::chrono::duration_cast<std::chrono::minutes>(now - getLastQuestionTime(vocabList_.back())).count();
-        
+        auto elapsedMinutes = std::chrono::duration_cast<std::chrono::minutes>(now - getLastQuestionTime(deck_->items.back())).count();
+
         // Predict recall based on the elapsed time
-        double predictedRecall = ebisuModel_.predictRecall(elapsedMinutes);
+        double predictedRecall = learner.model.predictRecall(elapsedMinutes);
 
         std::cout << "Success Rate: " << std::fixed << std::setprecision(2) << (successRate * 100) << "%" << std::endl;
         std::cout << "Predicted Recall: " << std::fixed << std::setprecision(2) << (predictedRecall * 100) << "%" << std::endl;
@@ -392,79 +694,43 @@ void Quiz::printStatistics() const {
 
 
 bool Quiz::validateAnswer(const std::string& answer) {
-    std::string trimmedAnswer = trim(answer);
-    std::string lowerAndTrimmedAnswer = toLowercaseAndTrim(trimmedAnswer);
-    if(lowerAndTrimmedAnswer.empty()){
-        std::cerr << "Please enter an answer." << std::endl;
-        return false;
-    }
-    if(!utf8::is_valid(lowerAndTrimmedAnswer.begin(), lowerAndTrimmedAnswer.end())){
-        std::cerr << "Answer contains invalid UTF-8 characters. Please try again." << std::endl;
-        return false;
-    }
-    if(hasLeadingOrTrailingWhitespace(trimmedAnswer)){
-        std::cerr << "Answer should not have leading or trailing whitespace. Please try again." << std::endl;
-        return false;
-    }
-    if(containsInvalidCharacters(lowerAndTrimmedAnswer)){
-        std::cerr << "Answer contains invalid characters. Please try again." << std::endl;
-        return false;
-    }
-    if(lowerAndTrimmedAnswer.find("--") != std::string::npos){
-        std::cerr << "Answer should not contain consecutive dashes (--). Please try again." << std::endl;
+    std::string error = QuizSession::answerError(answer);
+    if (!error.empty()) {
+        std::cerr << error << std::endl;
         return false;
     }
     return true;
 }
 
 bool Quiz::checkAnswer(const std::string& userAnswer, const std::string& correctAnswer) {
-    //convert to lowercase and trim whitespace
-    std::string userAnswerLowercase = toLowercaseAndTrim(userAnswer);
-    std::string correctAnswerLowercase = toLowercaseAndTrim(correctAnswer);
-
-    // Remove hyphens from user answer and correct answer
-    userAnswerLowercase.erase(std::remove(userAnswerLowercase.begin(), userAnswerLowercase.end(), '-'), userAnswerLowercase.end());
-    correctAnswerLowercase.erase(std::remove(correctAnswerLowercase.begin(), correctAnswerLowercase.end(), '-'), correctAnswerLowercase.end());
-
     // Check if the first or last character is a hyphen and return false if it is
-    if (userAnswer.front() == '-' || userAnswer.back() == '-' || correctAnswer.front() == '-' || correctAnswer.back() == '-') {
+    if (!userAnswer.empty() && !correctAnswer.empty() &&
+        (userAnswer.front() == '-' || userAnswer.back() == '-' || correctAnswer.front() == '-' || correctAnswer.back() == '-')) {
         std::cerr << "Hyphens at the beginning or end of the answer are not allowed. Please try again." << std::endl;
         return false;
     }
-    
-    return userAnswerLowercase == correctAnswerLowercase;
+    return QuizSession::answersMatch(userAnswer, correctAnswer);
+}
+
+bool Quiz::checkAnswer(const Vocab& vocab, const std::string& answer) {
+    return QuizSession::accepts(testType_, vocab, getCorrectAnswer(vocab), answer);
 }
 
 std::string Quiz::trim(const std::string& str, const char& trimChar) {
-    std::string trimmedString = str;
-    trimmedString.erase(trimmedString.begin(), std::find_if(trimmedString.begin(), trimmedString.end(), [&](unsigned char ch) {
-        return ch != trimChar;
-    }));
-    trimmedString.erase(std::find_if(trimmedString.rbegin(), trimmedString.rend(), [&](unsigned char ch) {
-        return ch != trimChar;
-    }).base(), trimmedString.end());
-    return trimmedString;
+    return QuizSession::trim(str, trimChar);
 }
 
 std::string Quiz::toLowercaseAndTrim(const std::string& str) {
-    std::string trimmedString = trim(str);
-    std::transform(trimmedString.begin(), trimmedString.end(), trimmedString.begin(), [](unsigned char c) {
-        return std::tolower(c);
-    });
-    return trimmedString;
+    return QuizSession::toLowercaseAndTrim(str);
 }
 
 std::string Quiz::getCorrectAnswer(const Vocab& vocab) {
-    if (testType_ == "Kanji to Hiragana") {
-        return vocab.getHiragana();
-    } else if (testType_ == "Hiragana to English") {
-        return vocab.getEnglish()[0];
-    } else if (testType_ == "Hiragana to Romaji") {
-        return vocab.getRomaji();
-    } else if (testType_ == "English to Hiragana") {
-        return vocab.getHiragana();
+    std::string answer = QuizSession::expectedAnswer(testType_, vocab);
+    if (answer.empty() && session_ && session_->pending() && deck_->indexOf(vocab) == session_->current().item) {
+        // Drills fix their answer when the question is asked.
+        answer = session_->expected();
     }
-    return "Invalid test type.";
+    return answer.empty() ? "Invalid test type." : answer;
 }
 
 std::string Quiz::getUserAnswer() {
@@ -482,40 +748,39 @@ std::string Quiz::getUserAnswer() {
 }
 
 bool Quiz::containsInvalidCharacters(const std::string& str) {
-    const std::string invalidChars = "!@#$%^&*()_+[],./={}':;";
-    std::regex reg("[" + std::regex_replace(invalidChars, std::regex("([\\[\\]])"), "\\$1") + "]");
-    return std::regex_search(str, reg);
+    return QuizSession::containsInvalidCharacters(str);
 }
 
 bool Quiz::containsWhitespace(const std::string& str) {
-    return std::any_of(str.begin(), str.end(), [](char c) {
-        return std::isspace(static_cast<unsigned char>(c));
-    });
+    return QuizSession::containsWhitespace(str);
 }
 
 bool Quiz::hasLeadingOrTrailingWhitespace(const std::string& str) {
-    return !str.empty() && (std::isspace(static_cast<unsigned char>(str.front())) || std::isspace(static_cast<unsigned char>(str.back())));
+    return QuizSession::hasLeadingOrTrailingWhitespace(str);
 }
 
 int Quiz::getTotalQuestions() const {
-    return totalQuestions_;
+    return static_cast<int>(learner().totalQuestions);
 }
 
 int Quiz::getCorrectAnswers() const {
-    return correctAnswers_;
+    return learner().correctAnswers;
 }
 
 std::chrono::steady_clock::time_point Quiz::getLastQuestionTime(const Vocab& vocab) const {
-    auto it = lastQuestionTimes_.find(&vocab);
-    if (it != lastQuestionTimes_.end()) {
-        return it->second;
+    size_t item = deck_->indexOf(vocab);
+    if (item != Deck::NOT_FOUND) {
+        return learner().lastAskedAt(item);
     }
     // Return the default time if the vocabulary is not found
     return std::chrono::steady_clock::time_point{};
 }
 
 void Quiz::setLastQuestionTime(Vocab& vocab, const std::chrono::steady_clock::time_point& time) {
-    lastQuestionTimes_[&vocab] = time;
+    size_t item = deck_->indexOf(vocab);
+    if (item != Deck::NOT_FOUND) {
+        learner().setLastAsked(item, time);
+    }
 }
 
 #endif  // QUIZ_H_
@@ -0,0 +1,500 @@
+#ifndef QUIZSESSION_H_
+#define QUIZSESSION_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cctype>
+
+#include "deck.h"
+#include "ebisu.h"
+#include "utf8/utf8.h"
+
+/**
+ * @brief What one learner has done so far; this is what quiz_state.json keeps.
+ */
+struct LearnerState {
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    size_t totalQuestions = 0;
+    int correctAnswers = 0;
+    Ebisu model;
+    std::vector<TimePoint> lastAsked;  /**< Per deck item; the epoch means never. */
+
+    TimePoint lastAskedAt(size_t item) const {
+        return item < lastAsked.size() ? lastAsked[item] : TimePoint();
+    }
+    void setLastAsked(size_t item, TimePoint time) {
+        if (item >= lastAsked.size()) lastAsked.resize(item + 1);
+        lastAsked[item] = time;
+    }
+
+    /**
+     * @brief Moves the per-item history from one version of a deck to the
+     *        next: items are matched by Deck::itemKey, new ones start unseen.
+     */
+    void remap(const Deck& from, const Deck& to);
+};
+
+void LearnerState::remap(const Deck& from, const Deck& to) {
+    std::unordered_map<std::string, TimePoint> byKey;
+    for (size_t i = 0; i < from.items.size() && i < lastAsked.size(); ++i) {
+        if (lastAsked[i] != TimePoint()) byKey[Deck::itemKey(from.items[i])] = lastAsked[i];
+    }
+    std::vector<TimePoint> remapped(to.items.size());
+    for (size_t i = 0; i < to.items.size(); ++i) {
+        auto found = byKey.find(Deck::itemKey(to.items[i]));
+        if (found != byKey.end()) remapped[i] = found->second;
+    }
+    lastAsked.swap(remapped);
+}
+
+/**
+ * @brief A question drawn by QuizSession::nextQuestion.
+ */
+struct SessionQuestion {
+    size_t item = Deck::NOT_FOUND;  /**< Index into the deck. */
+    std::string prompt;             /**< Empty if the item cannot be asked (see skipReason). */
+    std::string skipReason;
+    std::string correctAnswer;      /**< As shown to the learner once answered. */
+    bool listening = false;         /**< The item's audio is the question; the prompt does not show it. */
+    double predictedRecall = 0.0;
+    LearnerState::TimePoint lastAsked;  /**< Previous time the item was asked; the epoch means never. */
+};
+
+enum class AnswerStatus {
+    Correct,
+    Incorrect,
+    Invalid,  // not graded; the question is still open
+    Quit      // the learner asked to stop; the question is still open
+};
+
+struct AnswerResult {
+    AnswerStatus status = AnswerStatus::Invalid;
+    std::string message;  /**< Why an Invalid answer was rejected. */
+};
+
+/**
+ * @brief One learner's run through a deck, without any I/O.
+ *
+ * nextQuestion() draws and phrases a question, submitAnswer() grades it and
+ * updates the learner state; both only touch the session, so a terminal
+ * (Quiz), a test or a server holding thousands of sessions can drive them.
+ * The deck is shared read-only; everything that changes is in the session.
+ *
+ *     QuizSession session(deck, "Kanji to Hiragana", 10, learner);
+ *     while (!session.finished()) {
+ *         const SessionQuestion& question = session.nextQuestion();
+ *         AnswerResult result = session.submitAnswer(read(question.prompt));
+ *     }
+ */
+class QuizSession {
+public:
+    typedef std::chrono::steady_clock Clock;
+    /** Receives the next questions (soonest first, views of the deck's items) each time one is drawn. */
+    typedef std::function<void(const std::vector<Vocab>&)> UpcomingListener;
+
+    QuizSession(std::shared_ptr<const Deck> deck, const std::string& testType, size_t questionCount = 10,
+                const LearnerState& learner = LearnerState(), unsigned seed = std::random_device()());
+
+    /** @return Why this deck cannot be quizzed in this mode; empty if it can. */
+    const std::string& error() const { return error_; }
+    bool finished() const { return !error_.empty() || (asked_ >= questionCount_ && !pending_); }
+    bool pending() const { return pending_; }
+
+    const std::string& testType() const { return testType_; }
+    const Deck& deck() const { return *deck_; }
+    const LearnerState& learner() const { return learner_; }
+    LearnerState& learner() { return learner_; }
+    size_t asked() const { return asked_; }
+    size_t questionCount() const { return questionCount_; }
+
+    /**
+     * @brief Draws the next question, or returns the open one again if it
+     *        has not been answered. Once finished(), the result has no item.
+     */
+    const SessionQuestion& nextQuestion(Clock::time_point now = Clock::now());
+    const SessionQuestion& current() const { return question_; }
+    /** @return What the open question is graded against (for drills, e.g. the option number). */
+    const std::string& expected() const { return expected_; }
+
+    /** @brief Grades an answer to the open question; "q" / "quit" ask to stop. */
+    AnswerResult submitAnswer(const std::string& answer);
+
+    void setUpcomingListener(UpcomingListener listener, size_t lookahead = 3);
+
+    /**
+     * @brief Draws an item from candidates (any item if empty), lookahead
+     *        draws ahead so the listener can prepare them.
+     * @param remaining Questions left including this one; nothing is drawn past it.
+     */
+    size_t drawIndex(const std::vector<size_t>& candidates, size_t remaining);
+
+    /** @return Every mode, in the order of the quiz menu (numbered from 1). */
+    static const std::vector<std::string>& testTypes();
+
+    /** @return The answer a mode expects for an item; empty for drills, which fix it per question. */
+    static std::string expectedAnswer(const std::string& testType, const Vocab& vocab);
+    /** @return True if answer is right for the item; expected is what the question fixed. */
+    static bool accepts(const std::string& testType, const Vocab& vocab, const std::string& expected,
+                        const std::string& answer);
+    /** @return Case, surrounding blanks and hyphens ignored; no leading or trailing hyphen allowed. */
+    static bool answersMatch(const std::string& userAnswer, const std::string& correctAnswer);
+    /** @return Why an answer cannot be graded; empty if it can. */
+    static std::string answerError(const std::string& answer);
+
+    static std::string trim(const std::string& str, char trimChar = ' ');
+    static std::string toLowercaseAndTrim(const std::string& str);
+    static bool containsInvalidCharacters(const std::string& str);
+    static bool containsWhitespace(const std::string& str);
+    static bool hasLeadingOrTrailingWhitespace(const std::string& str);
+
+private:
+    void phrase(size_t item, const Vocab& vocab);
+
+    std::shared_ptr<const Deck> deck_;
+    std::string testType_;
+    size_t questionCount_;
+    LearnerState learner_;
+    std::mt19937 generator_;
+    std::string error_;
+    std::vector<size_t> candidates_;  /**< Items this mode can ask; empty means all. */
+    std::deque<size_t> upcoming_;     /**< Items drawn ahead of the current question. */
+    size_t lookahead_ = 0;
+    UpcomingListener upcomingListener_;
+    size_t asked_ = 0;
+    bool pending_ = false;
+    SessionQuestion question_;
+    std::string expected_;            /**< What the open question is graded against. */
+    Clock::time_point askedAt_;
+};
+
+QuizSession::QuizSession(std::shared_ptr<const Deck> deck, const std::string& testType, size_t questionCount,
+                         const LearnerState& learner, unsigned seed)
+    : deck_(std::move(deck)),
+      testType_(testType),
+      questionCount_(questionCount),
+      learner_(learner),
+      generator_(seed)
+{
+    if (testType_ == "Fill in the Blank") {
+        if (deck_->sentences.empty()) {
+            error_ = "No example sentences available.";
+        } else {
+            candidates_ = deck_->sentences.itemsWithSentences();
+            if (candidates_.empty()) error_ = "No example sentences match this deck.";
+        }
+    } else if (testType_ == "Confusable Kanji") {
+        if (deck_->kanji.empty()) {
+            error_ = "No kanji decomposition data available.";
+        } else {
+            for (size_t i = 0; i < deck_->items.size(); ++i) {
+                if (!deck_->kanji.confusableVariants(deck_->items[i].getKanji(), 1).empty()) {
+                    candidates_.push_back(i);
+                }
+            }
+            if (candidates_.empty()) error_ = "No confusable kanji found in this deck.";
+        }
+    } else if (testType_ == "Conjugation") {
+        candidates_ = deck_->conjugations.conjugableItems();
+        if (candidates_.empty()) error_ = "No verbs or adjectives in this deck.";
+    } else if (std::find(testTypes().begin(), testTypes().end(), testType_) == testTypes().end()) {
+        error_ = "Invalid test type.";
+    }
+
+    if (error_.empty() && deck_->items.empty()) {
+        error_ = "No vocabularies loaded.";
+    }
+}
+
+void QuizSession::setUpcomingListener(UpcomingListener listener, size_t lookahead) {
+    upcomingListener_ = std::move(listener);
+    lookahead_ = upcomingListener_ ? lookahead : 0;
+}
+
+size_t QuizSession::drawIndex(const std::vector<size_t>& candidates, size_t remaining) {
+    // Questions are drawn lookahead_ ahead of time so their audio can be
+    // prepared while the learner is still answering the current one.
+    size_t wanted = std::min(lookahead_ + 1, std::max<size_t>(remaining, 1));
+    while (upcoming_.size() < wanted) {
+        if (candidates.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, deck_->items.size() - 1);
+            upcoming_.push_back(pick(generator_));
+        } else {
+            std::uniform_int_distribution<size_t> pick(0, candidates.size() - 1);
+            upcoming_.push_back(candidates[pick(generator_)]);
+        }
+    }
+
+    size_t index = upcoming_.front();
+    upcoming_.pop_front();
+
+    if (upcomingListener_) {
+        std::vector<Vocab> next;
+        for (size_t upcoming : upcoming_) {
+            next.push_back(deck_->items[upcoming]);
+        }
+        upcomingListener_(next);
+    }
+    return index;
+}
+
+const SessionQuestion& QuizSession::nextQuestion(Clock::time_point now) {
+    if (pending_) return question_;
+
+    question_ = SessionQuestion();
+    expected_.clear();
+    if (finished()) {
+        question_.skipReason = error_.empty() ? "No questions left." : error_;
+        return question_;
+    }
+
+    size_t index = drawIndex(candidates_, questionCount_ - asked_);
+    ++asked_;
+    const Vocab vocab = deck_->items[index];
+    question_.item = index;
+    question_.lastAsked = learner_.lastAskedAt(index);
+
+    // Use the elapsed time since the item was last asked to predict recall
+    auto elapsedMinutes = std::chrono::duration_cast<std::chrono::minutes>(now - question_.lastAsked).count();
+    question_.predictedRecall = learner_.model.predictRecall(elapsedMinutes);
+
+    phrase(index, vocab);
+    if (!question_.prompt.empty()) {
+        pending_ = true;
+        askedAt_ = now;
+    }
+    return question_;
+}
+
+void QuizSession::phrase(size_t item, const Vocab& vocab) {
+    std::string& question = question_.prompt;
+    std::string& correctAnswer = question_.correctAnswer;
+
+    if (testType_ == "Kanji to Hiragana") {
+        question = "What is the hiragana reading of the following kanji? " + vocab.getKanji();
+        correctAnswer = vocab.getHiragana();
+    } else if (testType_ == "Hiragana to English") {
+        question = "What is the English meaning of the following hiragana? " + vocab.getHiragana();
+        correctAnswer = vocab.correctAnswer();
+    } else if (testType_ == "Hiragana to Romaji") {
+        question = "What is the romaji reading of the following hiragana? " + vocab.getHiragana();
+        correctAnswer = vocab.getRomaji();
+    } else if (testType_ == "English to Hiragana") {
+        question = "What is the hiragana reading of the following English word? " + vocab.correctAnswer();
+        correctAnswer = vocab.getHiragana();
+    } else if (testType_ == "Fill in the Blank") {
+        size_t count = deck_->sentences.postingCount(item);
+        if (count == 0) {
+            question_.skipReason = "No example sentence for " + vocab.getKanji() + ".";
+            return;
+        }
+        std::uniform_int_distribution<size_t> pick(0, count - 1);
+        const SentencePosting& posting = deck_->sentences.posting(item, pick(generator_));
+        const ExampleSentence& sentence = deck_->sentences.sentence(posting);
+        question = "Fill in the blank with the missing word in hiragana: " + deck_->sentences.blankSentence(posting);
+        if (!sentence.english.empty()) {
+            question += "\n(" + sentence.english + ")";
+        }
+        correctAnswer = vocab.getHiragana();
+    } else if (testType_ == "Confusable Kanji") {
+        std::vector<std::string> options = deck_->kanji.confusableVariants(vocab.getKanji(), 3);
+        if (options.empty()) {
+            question_.skipReason = "No confusable kanji for " + vocab.getKanji() + ".";
+            return;
+        }
+        options.push_back(vocab.getKanji());
+        std::shuffle(options.begin(), options.end(), generator_);
+
+        question = "Which word is " + vocab.getHiragana() + " (" + vocab.correctAnswer() + ")?";
+        for (size_t i = 0; i < options.size(); ++i) {
+            question += "\n" + std::to_string(i + 1) + ". " + options[i];
+            if (options[i] == vocab.getKanji()) {
+                expected_ = std::to_string(i + 1);
+            }
+        }
+        correctAnswer = expected_ + " (" + vocab.getKanji() + ")";
+    } else if (testType_ == "Conjugation") {
+        if (!deck_->conjugations.hasForms(item)) {
+            question_.skipReason = vocab.getKanji() + " cannot be conjugated.";
+            return;
+        }
+        std::uniform_int_distribution<size_t> pick(0, ConjugationTable::FORM_COUNT - 1);
+        ConjugationForm form = static_cast<ConjugationForm>(pick(generator_));
+        question = std::string("What is the ") + ConjugationTable::formName(form) + " of " +
+                   vocab.getKanji() + " (" + vocab.getHiragana() + ")? Answer in hiragana.";
+        expected_ = deck_->conjugations.form(item, form).str();
+        correctAnswer = expected_;
+    } else if (testType_ == "Listening Comprehension") {
+        question = "Listen and type the English meaning or the reading in hiragana.";
+        correctAnswer = vocab.getHiragana() + " (" + vocab.correctAnswer() + ")";
+        question_.listening = true;
+    }
+
+    if (expected_.empty()) {
+        expected_ = expectedAnswer(testType_, vocab);
+    }
+}
+
+AnswerResult QuizSession::submitAnswer(const std::string& answer) {
+    AnswerResult result;
+    if (!pending_) {
+        result.message = "No question to answer.";
+        return result;
+    }
+
+    std::string trimmedAnswer = trim(answer);
+    if (trimmedAnswer == "q" || trimmedAnswer == "quit") {
+        result.status = AnswerStatus::Quit;
+        return result;
+    }
+    result.message = answerError(trimmedAnswer);
+    if (!result.message.empty()) {
+        return result;
+    }
+
+    size_t item = question_.item;
+    bool correct = accepts(testType_, deck_->items[item], expected_, trimmedAnswer);
+    if (correct) {
+        ++learner_.correctAnswers;
+    }
+
+    // Elapsed time between the previous and this asking of the item, in minutes
+    auto elapsedMinutes = std::chrono::duration_cast<std::chrono::minutes>(askedAt_ - learner_.lastAskedAt(item)).count();
+    learner_.model.updateRecall(learner_.correctAnswers, learner_.totalQuestions, elapsedMinutes);
+    learner_.setLastAsked(item, askedAt_);
+    ++learner_.totalQuestions;
+
+    pending_ = false;
+    result.status = correct ? AnswerStatus::Correct : AnswerStatus::Incorrect;
+    return result;
+}
+
+const std::vector<std::string>& QuizSession::testTypes() {
+    static const std::vector<std::string> types = {
+        "Kanji to Hiragana",
+        "Hiragana to English",
+        "Hiragana to Romaji",
+        "English to Hiragana",
+        "Fill in the Blank",
+        "Confusable Kanji",
+        "Conjugation",
+        "Listening Comprehension"
+    };
+    return types;
+}
+
+std::string QuizSession::expectedAnswer(const std::string& testType, const Vocab& vocab) {
+    if (testType == "Kanji to Hiragana") {
+        return vocab.getHiragana();
+    } else if (testType == "Hiragana to English") {
+        return vocab.getEnglish().empty() ? std::string() : vocab.getEnglish()[0];
+    } else if (testType == "Hiragana to Romaji") {
+        return vocab.getRomaji();
+    } else if (testType == "English to Hiragana") {
+        return vocab.getHiragana();
+    } else if (testType == "Fill in the Blank" || testType == "Listening Comprehension") {
+        return vocab.getHiragana();
+    }
+    return "";
+}
+
+bool QuizSession::accepts(const std::string& testType, const Vocab& vocab, const std::string& expected,
+                          const std::string& answer) {
+    if (testType == "Listening Comprehension") {
+        // Either the reading or any of the meanings shows the word was understood.
+        if (answersMatch(answer, vocab.getHiragana())) {
+            return true;
+        }
+        for (const std::string& english : vocab.getEnglish()) {
+            if (!english.empty() && answersMatch(answer, english)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return answersMatch(answer, expected);
+}
+
+bool QuizSession::answersMatch(const std::string& userAnswer, const std::string& correctAnswer) {
+    if (userAnswer.empty() || correctAnswer.empty()) {
+        return false;
+    }
+    // Hyphens at the beginning or end of the answer are not allowed.
+    if (userAnswer.front() == '-' || userAnswer.back() == '-' || correctAnswer.front() == '-' || correctAnswer.back() == '-') {
+        return false;
+    }
+
+    //convert to lowercase and trim whitespace
+    std::string userAnswerLowercase = toLowercaseAndTrim(userAnswer);
+    std::string correctAnswerLowercase = toLowercaseAndTrim(correctAnswer);
+
+    // Remove hyphens from user answer and correct answer
+    userAnswerLowercase.erase(std::remove(userAnswerLowercase.begin(), userAnswerLowercase.end(), '-'), userAnswerLowercase.end());
+    correctAnswerLowercase.erase(std::remove(correctAnswerLowercase.begin(), correctAnswerLowercase.end(), '-'), correctAnswerLowercase.end());
+
+    return userAnswerLowercase == correctAnswerLowercase;
+}
+
+std::string QuizSession::answerError(const std::string& answer) {
+    std::string trimmedAnswer = trim(answer);
+    std::string lowerAndTrimmedAnswer = toLowercaseAndTrim(trimmedAnswer);
+    if (lowerAndTrimmedAnswer.empty()) {
+        return "Please enter an answer.";
+    }
+    if (!utf8::is_valid(lowerAndTrimmedAnswer.begin(), lowerAndTrimmedAnswer.end())) {
+        return "Answer contains invalid UTF-8 characters. Please try again.";
+    }
+    if (hasLeadingOrTrailingWhitespace(trimmedAnswer)) {
+        return "Answer should not have leading or trailing whitespace. Please try again.";
+    }
+    if (containsInvalidCharacters(lowerAndTrimmedAnswer)) {
+        return "Answer contains invalid characters. Please try again.";
+    }
+    if (lowerAndTrimmedAnswer.find("--") != std::string::npos) {
+        return "Answer should not contain consecutive dashes (--). Please try again.";
+    }
+    return "";
+}
+
+std::string QuizSession::trim(const std::string& str, char trimChar) {
+    std::string trimmedString = str;
+    trimmedString.erase(trimmedString.begin(), std::find_if(trimmedString.begin(), trimmedString.end(), [&](unsigned char ch) {
+        return ch != trimChar;
+    }));
+    trimmedString.erase(std::find_if(trimmedString.rbegin(), trimmedString.rend(), [&](unsigned char ch) {
+        return ch != trimChar;
+    }).base(), trimmedString.end());
+    return trimmedString;
+}
+
+std::string QuizSession::toLowercaseAndTrim(const std::string& str) {
+    std::string trimmedString = trim(str);
+    std::transform(trimmedString.begin(), trimmedString.end(), trimmedString.begin(), [](unsigned char c) {
+        return std::tolower(c);
+    });
+    return trimmedString;
+}
+
+bool QuizSession::containsInvalidCharacters(const std::string& str) {
+    // A plain set lookup; this runs for every answer a server grades.
+    return str.find_first_of("!@#$%^&*()_+[],./={}':;") != std::string::npos;
+}
+
+bool QuizSession::containsWhitespace(const std::string& str) {
+    return std::any_of(str.begin(), str.end(), [](char c) {
+        return std::isspace(static_cast<unsigned char>(c));
+    });
+}
+
+bool QuizSession::hasLeadingOrTrailingWhitespace(const std::string& str) {
+    return !str.empty() && (std::isspace(static_cast<unsigned char>(str.front())) || std::isspace(static_cast<unsigned char>(str.back())));
+}
+
+#endif  // QUIZSESSION_H_
@@ -21,7 +21,11 @@ QuizSettings::QuizSettings() {
         {1, "Kanji to Hiragana"},
         {2, "Hiragana to English"},
         {3, "Hiragana to Romaji"},
-        {4, "English to Hiragana"}
+        {4, "English to Hiragana"},
+        {5, "Fill in the Blank"},
+        {6, "Confusable Kanji"},
+        {7, "Conjugation"},
+        {8, "Listening Comprehension"}
     };
 }
 
@@ -39,6 +43,14 @@ std::string QuizSettings::getQuestionFormat() const {
         return "Translate the following hiragana to romaji: ";
     else if (testType == "English to Hiragana")
         return "Translate the following English word to hiragana: ";
+    else if (testType == "Fill in the Blank")
+        return "Fill in the blank with the missing word in hiragana: ";
+    else if (testType == "Confusable Kanji")
+        return "Choose the correctly written kanji: ";
+    else if (testType == "Conjugation")
+        return "Conjugate the following word in hiragana: ";
+    else if (testType == "Listening Comprehension")
+        return "Listen and type the English meaning or the reading in hiragana: ";
     else
         return "Invalid test type.";
 }
\ No newline at end of file
@@ -0,0 +1,527 @@
+#ifndef SENTENCEINDEX_H_
+#define SENTENCEINDEX_H_
+
+#include <string>
+#include <vector>
+#include <array>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+#include "vocab.h"
+#include "vocablist.h"
+#include "itemkeys.h"
+#include "flatarray.h"
+#include "deckimage.h"
+#include "utf8/utf8.h"
+
+/**
+ * @brief Multi-pattern byte matcher (Aho-Corasick automaton).
+ *        Patterns are matched on raw UTF-8 bytes, so a full scan of a
+ *        sentence is a single pass regardless of how many patterns exist.
+ */
+class AhoCorasick {
+public:
+    AhoCorasick();
+
+    void addPattern(const std::string& pattern, int id);
+    void build();
+    bool empty() const { return nodes_.size() == 1; }
+
+    /**
+     * @brief Scans text and calls onMatch(id, begin, length) for every pattern occurrence.
+     */
+    template <typename Fn>
+    void scan(const std::string& text, Fn onMatch) const;
+
+private:
+    struct Node {
+        std::vector<std::pair<unsigned char, int>> next; /**< Sorted child edges. */
+        int fail = 0;                                    /**< Longest proper suffix state. */
+        int outputLink = -1;                             /**< Nearest suffix state with output. */
+        std::vector<int> outputs;                        /**< Pattern ids ending here. */
+        int depth = 0;
+    };
+
+    int child(int node, unsigned char c) const;
+    int step(int node, unsigned char c) const;
+
+    std::vector<Node> nodes_;
+    std::array<int, 256> rootNext_; /**< Dense root transitions, the hottest state. */
+    bool built_ = false;
+};
+
+AhoCorasick::AhoCorasick() : nodes_(1) {
+    rootNext_.fill(0);
+}
+
+void AhoCorasick::addPattern(const std::string& pattern, int id) {
+    if (pattern.empty()) return;
+
+    int node = 0;
+    for (unsigned char c : pattern) {
+        int next = child(node, c);
+        if (next < 0) {
+            next = static_cast<int>(nodes_.size());
+            nodes_.emplace_back();
+            nodes_[next].depth = nodes_[node].depth + 1;
+            auto& edges = nodes_[node].next;
+            auto pos = std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, 0));
+            edges.insert(pos, std::make_pair(c, next));
+        }
+        node = next;
+    }
+    nodes_[node].outputs.push_back(id);
+    built_ = false;
+}
+
+int AhoCorasick::child(int node, unsigned char c) const {
+    const auto& edges = nodes_[node].next;
+    auto pos = std::lower_bound(edges.begin(), edges.end(), std::make_pair(c, 0));
+    if (pos != edges.end() && pos->first == c) return pos->second;
+    return -1;
+}
+
+void AhoCorasick::build() {
+    rootNext_.fill(0);
+    for (const auto& edge : nodes_[0].next) {
+        rootNext_[edge.first] = edge.second;
+    }
+
+    // Breadth-first so every fail target is finished before it is used.
+    std::deque<int> queue;
+    for (const auto& edge : nodes_[0].next) {
+        nodes_[edge.second].fail = 0;
+        queue.push_back(edge.second);
+    }
+
+    while (!queue.empty()) {
+        int node = queue.front();
+        queue.pop_front();
+
+        for (const auto& edge : nodes_[node].next) {
+            int target = edge.second;
+            int fail = nodes_[node].fail;
+            while (fail != 0 && child(fail, edge.first) < 0) {
+                fail = nodes_[fail].fail;
+            }
+            int next = child(fail, edge.first);
+            nodes_[target].fail = (next >= 0 && next != target) ? next : 0;
+
+            int suffix = nodes_[target].fail;
+            nodes_[target].outputLink = nodes_[suffix].outputs.empty() ? nodes_[suffix].outputLink : suffix;
+            queue.push_back(target);
+        }
+    }
+    built_ = true;
+}
+
+int AhoCorasick::step(int node, unsigned char c) const {
+    while (node != 0) {
+        int next = child(node, c);
+        if (next >= 0) return next;
+        node = nodes_[node].fail;
+    }
+    return rootNext_[c];
+}
+
+template <typename Fn>
+void AhoCorasick::scan(const std::string& text, Fn onMatch) const {
+    if (!built_) return;
+
+    int node = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        node = step(node, static_cast<unsigned char>(text[i]));
+        for (int out = nodes_[node].outputs.empty() ? nodes_[node].outputLink : node; out > 0; out = nodes_[out].outputLink) {
+            size_t length = static_cast<size_t>(nodes_[out].depth);
+            for (int id : nodes_[out].outputs) {
+                onMatch(id, i + 1 - length, length);
+            }
+        }
+    }
+}
+
+/**
+ * @brief An example sentence taken from the corpus.
+ */
+struct ExampleSentence {
+    std::string japanese;
+    std::string english;
+};
+
+/**
+ * @brief One occurrence of a deck item inside an example sentence.
+ */
+struct SentencePosting {
+    uint32_t sentence; /**< Index into the retained sentence list. */
+    uint32_t offset;   /**< Byte offset of the surface form in the sentence. */
+    uint32_t length;   /**< Byte length of the surface form. */
+};
+
+/**
+ * @brief Item -> example sentence postings built from a Tatoeba-style TSV corpus.
+ *
+ * Accepted corpus lines:
+ *   id <TAB> jpn <TAB> text                          (sentences.csv export)
+ *   id <TAB> japanese <TAB> id <TAB> english         (sentence pairs export)
+ *   japanese <TAB> english
+ * Sentences that contain no deck item are dropped, so the index only holds
+ * what the fill-in-the-blank mode can actually serve.
+ */
+class SentenceIndex {
+public:
+    static const size_t MAX_POSTINGS_PER_ITEM = 16;
+    static const size_t MIN_SURFACE_CODEPOINTS = 2;
+
+    size_t build(const VocabList& vocabList, const std::string& corpusFile);
+    bool empty() const { return postings_.empty(); }
+    size_t sentenceCount() const { return sentences_.size(); }
+
+    size_t postingCount(const Vocab& vocab) const;
+    const SentencePosting& posting(const Vocab& vocab, size_t n) const;
+    /** @brief The same by the item's index in the deck, without looking it up. */
+    size_t postingCount(size_t item) const;
+    const SentencePosting& posting(size_t item, size_t n) const;
+    ExampleSentence sentence(const SentencePosting& posting) const;
+    std::string blankSentence(const SentencePosting& posting, const std::string& blank = "＿＿＿") const;
+    std::vector<size_t> itemsWithSentences() const;
+
+    nlohmann::json toJson() const;
+    /** @return False, leaving the index empty, if the postings do not fit the sentences. */
+    bool fromJson(const nlohmann::json& jsonIndex);
+
+    /** @brief Adds the sentences and postings to a deck image. */
+    void writeImage(DeckImageWriter& image) const;
+    /** @brief Reads the sentences and postings in place; keys are those of the deck the image was built from. */
+    bool readImage(const DeckImage& image, const ItemKeys& keys);
+
+    static std::string deckFingerprint(const VocabList& vocabList);
+    const std::string& getDeckFingerprint() const { return fingerprint_; }
+
+private:
+    /** @brief Where a sentence's two texts are in the text pool. */
+    struct SentenceText {
+        uint32_t japanese;
+        uint32_t japaneseBytes;
+        uint32_t english;
+        uint32_t englishBytes;
+    };
+
+    static bool parseCorpusLine(const std::string& line, ExampleSentence& sentence);
+    void clearSentences();
+    void addSentence(const ExampleSentence& sentence);
+    void clear();
+    /** @return True if every row, posting and text span lies inside the index. */
+    bool consistent(size_t itemCount) const;
+
+    FlatArray<char> text_;                 /**< Every sentence's text, back to back. */
+    FlatArray<SentenceText> sentences_;
+    FlatArray<uint32_t> offsets_;          /**< CSR row offsets, one row per deck item. */
+    FlatArray<SentencePosting> postings_;  /**< CSR payload. */
+    ItemKeys keys_;
+    std::string fingerprint_;
+};
+
+std::string SentenceIndex::deckFingerprint(const VocabList& vocabList) {
+    // FNV-1a over every surface form; cheap and stable across runs.
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto& vocab : vocabList) {
+        for (unsigned char c : ItemKeys::key(vocab) + "\n") {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+    }
+    std::stringstream ss;
+    ss << vocabList.size() << "-" << std::hex << hash;
+    return ss.str();
+}
+
+void SentenceIndex::clearSentences() {
+    text_.edit().clear();
+    sentences_.edit().clear();
+}
+
+void SentenceIndex::addSentence(const ExampleSentence& sentence) {
+    std::vector<char>& text = text_.edit();
+    SentenceText entry;
+    entry.japanese = static_cast<uint32_t>(text.size());
+    entry.japaneseBytes = static_cast<uint32_t>(sentence.japanese.size());
+    text.insert(text.end(), sentence.japanese.begin(), sentence.japanese.end());
+    entry.english = static_cast<uint32_t>(text.size());
+    entry.englishBytes = static_cast<uint32_t>(sentence.english.size());
+    text.insert(text.end(), sentence.english.begin(), sentence.english.end());
+    sentences_.edit().push_back(entry);
+}
+
+void SentenceIndex::clear() {
+    clearSentences();
+    offsets_.edit().clear();
+    postings_.edit().clear();
+    keys_.clear();
+    fingerprint_.clear();
+}
+
+bool SentenceIndex::consistent(size_t itemCount) const {
+    if (offsets_.empty()) {
+        return postings_.empty();
+    }
+    if (offsets_.size() != itemCount + 1 || offsets_.front() != 0 || offsets_.back() != postings_.size()) {
+        return false;
+    }
+    for (size_t i = 1; i < offsets_.size(); ++i) {
+        if (offsets_[i] < offsets_[i - 1]) return false;
+    }
+    for (const SentenceText& entry : sentences_) {
+        if (static_cast<size_t>(entry.japanese) + entry.japaneseBytes > text_.size() ||
+            static_cast<size_t>(entry.english) + entry.englishBytes > text_.size()) {
+            return false;
+        }
+    }
+    for (const SentencePosting& posting : postings_) {
+        if (posting.sentence >= sentences_.size() ||
+            static_cast<size_t>(posting.offset) + posting.length > sentences_[posting.sentence].japaneseBytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SentenceIndex::parseCorpusLine(const std::string& line, ExampleSentence& sentence) {
+    std::vector<std::string> columns;
+    std::stringstream ss(line);
+    std::string column;
+    while (std::getline(ss, column, '\t')) {
+        if (!column.empty() && column.back() == '\r') column.pop_back();
+        columns.push_back(column);
+    }
+
+    if (columns.size() >= 4) {
+        sentence.japanese = columns[1];
+        sentence.english = columns[3];
+    } else if (columns.size() == 3) {
+        if (columns[1] != "jpn") return false;
+        sentence.japanese = columns[2];
+        sentence.english.clear();
+    } else if (columns.size() == 2) {
+        sentence.japanese = columns[0];
+        sentence.english = columns[1];
+    } else {
+        return false;
+    }
+    return !sentence.japanese.empty() && utf8::is_valid(sentence.japanese.begin(), sentence.japanese.end());
+}
+
+size_t SentenceIndex::build(const VocabList& vocabList, const std::string& corpusFile) {
+    std::ifstream file(corpusFile);
+    if (!file) {
+        std::cerr << "Failed to open sentence corpus: " << corpusFile << std::endl;
+        return 0;
+    }
+
+    AhoCorasick automaton;
+    for (size_t i = 0; i < vocabList.size(); ++i) {
+        const Vocab vocab = vocabList[i];
+        const std::string kanji = vocab.getKanji();
+        const std::string hiragana = vocab.getHiragana();
+        for (const std::string& surface : { kanji, hiragana }) {
+            if (!utf8::is_valid(surface.begin(), surface.end())) continue;
+            // Single kana such as particles would match nearly every sentence.
+            if (utf8::distance(surface.begin(), surface.end()) < static_cast<std::ptrdiff_t>(MIN_SURFACE_CODEPOINTS)) continue;
+            automaton.addPattern(surface, static_cast<int>(i));
+        }
+    }
+    automaton.build();
+
+    std::vector<std::vector<SentencePosting>> rows(vocabList.size());
+    clearSentences();
+
+    std::string line;
+    ExampleSentence sentence;
+    std::vector<SentencePosting> hits(vocabList.size());
+    std::vector<int> touched;
+
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (!parseCorpusLine(line, sentence)) continue;
+
+        touched.clear();
+        uint32_t sentenceId = static_cast<uint32_t>(sentences_.size());
+        automaton.scan(sentence.japanese, [&](int id, size_t begin, size_t length) {
+            if (rows[id].size() >= MAX_POSTINGS_PER_ITEM) return;
+            SentencePosting& hit = hits[id];
+            bool seen = std::find(touched.begin(), touched.end(), id) != touched.end();
+            // Keep the longest form per item, e.g. prefer 友達 over ともだち.
+            if (!seen) {
+                touched.push_back(id);
+                hit = { sentenceId, static_cast<uint32_t>(begin), static_cast<uint32_t>(length) };
+            } else if (length > hit.length) {
+                hit = { sentenceId, static_cast<uint32_t>(begin), static_cast<uint32_t>(length) };
+            }
+        });
+
+        if (touched.empty()) continue;
+        for (int id : touched) {
+            rows[id].push_back(hits[id]);
+        }
+        addSentence(sentence);
+    }
+
+    std::vector<uint32_t>& offsets = offsets_.edit();
+    std::vector<SentencePosting>& postings = postings_.edit();
+    offsets.assign(1, 0);
+    postings.clear();
+    for (const auto& row : rows) {
+        postings.insert(postings.end(), row.begin(), row.end());
+        offsets.push_back(static_cast<uint32_t>(postings.size()));
+    }
+
+    keys_.build(vocabList);
+    fingerprint_ = deckFingerprint(vocabList);
+    return sentences_.size();
+}
+
+size_t SentenceIndex::postingCount(const Vocab& vocab) const {
+    size_t item = keys_.find(vocab);
+    return item == ItemKeys::NOT_FOUND ? 0 : postingCount(item);
+}
+
+const SentencePosting& SentenceIndex::posting(const Vocab& vocab, size_t n) const {
+    size_t item = keys_.find(vocab);
+    if (item == ItemKeys::NOT_FOUND || n >= postingCount(item)) {
+        throw std::out_of_range("No example sentence for: " + vocab.getKanji());
+    }
+    return postings_[offsets_[item] + n];
+}
+
+size_t SentenceIndex::postingCount(size_t item) const {
+    if (item >= keys_.size() || item + 1 >= offsets_.size()) return 0;
+    return offsets_[item + 1] - offsets_[item];
+}
+
+const SentencePosting& SentenceIndex::posting(size_t item, size_t n) const {
+    if (n >= postingCount(item)) {
+        throw std::out_of_range("No example sentence for item " + std::to_string(item));
+    }
+    return postings_[offsets_[item] + n];
+}
+
+ExampleSentence SentenceIndex::sentence(const SentencePosting& posting) const {
+    if (posting.sentence >= sentences_.size()) {
+        throw std::out_of_range("No such sentence: " + std::to_string(posting.sentence));
+    }
+    const SentenceText& entry = sentences_[posting.sentence];
+    return { std::string(text_.data() + entry.japanese, entry.japaneseBytes),
+             std::string(text_.data() + entry.english, entry.englishBytes) };
+}
+
+std::string SentenceIndex::blankSentence(const SentencePosting& posting, const std::string& blank) const {
+    const std::string text = sentence(posting).japanese;
+    std::string result;
+    result.reserve(text.size() - posting.length + blank.size());
+    result.append(text, 0, posting.offset);
+    result.append(blank);
+    result.append(text, posting.offset + posting.length, std::string::npos);
+    return result;
+}
+
+std::vector<size_t> SentenceIndex::itemsWithSentences() const {
+    std::vector<size_t> items;
+    for (size_t i = 0; i + 1 < offsets_.size(); ++i) {
+        if (offsets_[i + 1] > offsets_[i]) items.push_back(i);
+    }
+    return items;
+}
+
+nlohmann::json SentenceIndex::toJson() const {
+    nlohmann::json jsonIndex;
+    jsonIndex["deck_fingerprint"] = fingerprint_;
+    jsonIndex["sentences"] = nlohmann::json::array();
+    for (uint32_t i = 0; i < sentences_.size(); ++i) {
+        ExampleSentence sentence = this->sentence({ i, 0, 0 });
+        jsonIndex["sentences"].push_back({ sentence.japanese, sentence.english });
+    }
+    jsonIndex["offsets"] = std::vector<uint32_t>(offsets_.begin(), offsets_.end());
+
+    // Postings are stored flat as (sentence, offset, length) triples.
+    std::vector<uint32_t> flat;
+    flat.reserve(postings_.size() * 3);
+    for (const auto& posting : postings_) {
+        flat.push_back(posting.sentence);
+        flat.push_back(posting.offset);
+        flat.push_back(posting.length);
+    }
+    jsonIndex["postings"] = flat;
+
+    // Rows are matched to items by the hash of their kanji and hiragana.
+    jsonIndex["item_keys"] = keys_.rowHashes();
+    return jsonIndex;
+}
+
+bool SentenceIndex::fromJson(const nlohmann::json& jsonIndex) {
+    if (!jsonIndex.contains("sentences") || !jsonIndex.contains("offsets") ||
+        !jsonIndex.contains("postings") || (!jsonIndex.contains("item_keys") && !jsonIndex.contains("items"))) {
+        throw std::invalid_argument("Invalid JSON format for sentence index.");
+    }
+
+    fingerprint_ = jsonIndex.value("deck_fingerprint", "");
+
+    clearSentences();
+    for (const auto& pair : jsonIndex["sentences"]) {
+        addSentence({ pair.at(0).get<std::string>(), pair.at(1).get<std::string>() });
+    }
+
+    offsets_ = jsonIndex["offsets"].get<std::vector<uint32_t>>();
+    std::vector<uint32_t> flat = jsonIndex["postings"].get<std::vector<uint32_t>>();
+    std::vector<SentencePosting>& postings = postings_.edit();
+    postings.clear();
+    for (size_t i = 0; i + 2 < flat.size(); i += 3) {
+        postings.push_back({ flat[i], flat[i + 1], flat[i + 2] });
+    }
+
+    // Files written before item_keys list the keys themselves.
+    std::vector<uint64_t> hashes;
+    if (jsonIndex.contains("item_keys")) {
+        hashes = jsonIndex["item_keys"].get<std::vector<uint64_t>>();
+    } else {
+        for (const auto& key : jsonIndex["items"].get<std::vector<std::string>>()) {
+            hashes.push_back(ItemKeys::hash(key));
+        }
+    }
+    keys_.assign(hashes);
+
+    // A hand-edited or stale file must not point past the sentences.
+    if (!consistent(hashes.size())) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void SentenceIndex::writeImage(DeckImageWriter& image) const {
+    image.add(DeckSection::SentenceText, text_);
+    image.add(DeckSection::Sentences, sentences_);
+    image.add(DeckSection::SentenceOffsets, offsets_);
+    image.add(DeckSection::SentencePostings, postings_);
+    image.add(DeckSection::SentenceFingerprint, fingerprint_);
+}
+
+bool SentenceIndex::readImage(const DeckImage& image, const ItemKeys& keys) {
+    text_ = image.section<char>(DeckSection::SentenceText);
+    sentences_ = image.section<SentenceText>(DeckSection::Sentences);
+    offsets_ = image.section<uint32_t>(DeckSection::SentenceOffsets);
+    postings_ = image.section<SentencePosting>(DeckSection::SentencePostings);
+    // An image compiled without a corpus has an empty index, which is consistent too.
+    if (!consistent(keys.size())) {
+        clear();
+        return false;
+    }
+    fingerprint_ = image.text(DeckSection::SentenceFingerprint);
+    keys_ = keys;
+    return true;
+}
+
+#endif  // SENTENCEINDEX_H_
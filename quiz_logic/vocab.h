@@ -6,10 +6,37 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <chrono>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
+/** @brief Where a string is in a VocabList's string pool. */
+struct VocabText {
+    uint32_t offset;
+    uint32_t length;
+};
+
+/**
+ * @brief An item as a VocabList stores it. Plain, so a deck image holds the
+ *        records as they are and a mapped list reads them in place.
+ */
+struct VocabRecord {
+    VocabText kanji;
+    VocabText hiragana;
+    VocabText romaji;
+    VocabText partOfSpeech;
+    VocabText dialogue;
+    VocabText lesson;
+    uint32_t english;       /**< First meaning in the list's English array. */
+    uint32_t englishCount;
+    double difficulty;
+};
+
 class Vocab {
 private:
+    friend class VocabList;
+
+
     std::string kanji_;
     std::string hiragana_;
     std::string romaji_;
@@ -20,6 +47,24 @@ private:
     double difficulty_ = 0.0; // default initializer
     std::chrono::steady_clock::time_point lastQuestionTime_;
 
+    // Set when this Vocab is a view of a VocabList item: the fields above are
+    // then unused and the getters read the list's arrays.
+    const VocabRecord* record_ = nullptr;
+    const VocabText* meanings_ = nullptr;
+    const char* strings_ = nullptr;
+
+    /** @brief A view of a VocabList item; its last question time is unset. */
+    Vocab(const VocabRecord* record, const VocabText* meanings, const char* strings)
+        : lastQuestionTime_(),
+          record_(record),
+          meanings_(meanings),
+          strings_(strings)
+    {}
+
+    std::string text(const VocabText& ref) const;
+    /** @brief Copies a view's fields into this Vocab, so it can be changed. */
+    void own();
+
 public:
     Vocab()
         : kanji_(""),
@@ -76,14 +121,14 @@ public:
 
 nlohmann::json Vocab::toJson() const {
     nlohmann::json vocabJson;
-    vocabJson["kanji"] = kanji_;
-    vocabJson["hiragana"] = hiragana_;
-    vocabJson["romaji"] = romaji_;
-    vocabJson["english"] = english_;
-    vocabJson["part_of_speech"] = partOfSpeech_;
-    vocabJson["dialogue"] = dialogue_;
-    vocabJson["lesson"] = lesson_;
-    vocabJson["difficulty"] = difficulty_;
+    vocabJson["kanji"] = getKanji();
+    vocabJson["hiragana"] = getHiragana();
+    vocabJson["romaji"] = getRomaji();
+    vocabJson["english"] = getEnglish();
+    vocabJson["part_of_speech"] = getPartOfSpeech();
+    vocabJson["dialogue"] = getDialogue();
+    vocabJson["lesson"] = getLesson();
+    vocabJson["difficulty"] = getDifficulty();
     vocabJson["last_question_time"] = lastQuestionTime_.time_since_epoch().count();
     return vocabJson;
 }
@@ -122,14 +167,14 @@ void Vocab::saveToPersistenceFile(const std::string& filename) const {
     }
 
     nlohmann::json jsonData = {
-        {"kanji", kanji_},
-        {"hiragana", hiragana_},
-        {"romaji", romaji_},
-        {"english", english_},
-        {"part_of_speech", partOfSpeech_},
-        {"dialogue", dialogue_},
-        {"lesson", lesson_},
-        {"difficulty", difficulty_},
+        {"kanji", getKanji()},
+        {"hiragana", getHiragana()},
+        {"romaji", getRomaji()},
+        {"english", getEnglish()},
+        {"part_of_speech", getPartOfSpeech()},
+        {"dialogue", getDialogue()},
+        {"lesson", getLesson()},
+        {"difficulty", getDifficulty()},
         {"last_question_time", std::chrono::time_point_cast<std::chrono::nanoseconds>(lastQuestionTime_).time_since_epoch().count()}
     };
 
@@ -144,68 +189,113 @@ void Vocab::saveToPersistenceFile(const std::string& filename) const {
     }
 }
 
-std::string Vocab::getKanji() const { return kanji_; }
+std::string Vocab::text(const VocabText& ref) const {
+    return ref.length ? std::string(strings_ + ref.offset, ref.length) : std::string();
+}
 
-std::string Vocab::getHiragana() const { return hiragana_; }
+void Vocab::own() {
+    if (!record_) return;
+    const VocabRecord* record = record_;
+    kanji_ = text(record->kanji);
+    hiragana_ = text(record->hiragana);
+    romaji_ = text(record->romaji);
+    english_ = getEnglish();
+    partOfSpeech_ = text(record->partOfSpeech);
+    dialogue_ = text(record->dialogue);
+    lesson_ = text(record->lesson);
+    difficulty_ = record->difficulty;
+    record_ = nullptr;
+    meanings_ = nullptr;
+    strings_ = nullptr;
+}
 
-std::string Vocab::getRomaji() const { return romaji_; }
+std::string Vocab::getKanji() const { return record_ ? text(record_->kanji) : kanji_; }
 
-std::vector<std::string> Vocab::getEnglish() const { return english_; }
+std::string Vocab::getHiragana() const { return record_ ? text(record_->hiragana) : hiragana_; }
 
-std::string Vocab::getPartOfSpeech() const { return partOfSpeech_; }
+std::string Vocab::getRomaji() const { return record_ ? text(record_->romaji) : romaji_; }
 
-std::string Vocab::getDialogue() const { return dialogue_; }
+std::vector<std::string> Vocab::getEnglish() const {
+    if (!record_) return english_;
+    std::vector<std::string> english;
+    english.reserve(record_->englishCount);
+    for (uint32_t i = 0; i < record_->englishCount; ++i) {
+        english.push_back(text(meanings_[record_->english + i]));
+    }
+    return english;
+}
 
-std::string Vocab::getLesson() const { return lesson_; }
+std::string Vocab::getPartOfSpeech() const { return record_ ? text(record_->partOfSpeech) : partOfSpeech_; }
 
-double Vocab::getDifficulty() const { return difficulty_; }
+std::string Vocab::getDialogue() const { return record_ ? text(record_->dialogue) : dialogue_; }
 
-void Vocab::setKanji(const std::string& newKanji) { kanji_ = newKanji; }
+std::string Vocab::getLesson() const { return record_ ? text(record_->lesson) : lesson_; }
+
+double Vocab::getDifficulty() const { return record_ ? record_->difficulty : difficulty_; }
+
+void Vocab::setKanji(const std::string& newKanji) {
+    own();
+    kanji_ = newKanji;
+}
 
 void Vocab::setHiragana(const std::string& newHiragana) {
+    own();
     hiragana_ = newHiragana;
 }
 
-void Vocab::setRomaji(const std::string& newRomaji) { romaji_ = newRomaji; }
+void Vocab::setRomaji(const std::string& newRomaji) {
+    own();
+    romaji_ = newRomaji;
+}
 
 void Vocab::setEnglish(const std::vector<std::string>& newEnglish) {
+    own();
     english_ = newEnglish;
 }
 
 void Vocab::setPartOfSpeech(const std::string& newPartOfSpeech) {
+    own();
     partOfSpeech_ = newPartOfSpeech;
 }
 
 void Vocab::setDialogue(const std::string& newDialogue) {
+    own();
     dialogue_ = newDialogue;
 }
 
-void Vocab::setLesson(const std::string& newLesson) { lesson_ = newLesson; }
+void Vocab::setLesson(const std::string& newLesson) {
+    own();
+    lesson_ = newLesson;
+}
 
-void Vocab::setDifficulty(double newDifficulty) { difficulty_ = newDifficulty; }
+void Vocab::setDifficulty(double newDifficulty) {
+    own();
+    difficulty_ = newDifficulty;
+}
 
 void Vocab::printDetails() const {
-    std::cout << "Kanji: " << kanji_ << std::endl;
-    std::cout << "Hiragana: " << hiragana_ << std::endl;
-    std::cout << "Romaji: " << romaji_ << std::endl;
+    std::cout << "Kanji: " << getKanji() << std::endl;
+    std::cout << "Hiragana: " << getHiragana() << std::endl;
+    std::cout << "Romaji: " << getRomaji() << std::endl;
 
     std::cout << "English(s): ";
-    for (const auto& m : english_) {
+    for (const auto& m : getEnglish()) {
         std::cout << m << ", ";
     }
     std::cout << std::endl;
 
-    std::cout << "Part of Speech: " << partOfSpeech_ << std::endl;
-    std::cout << "Dialogue: " << dialogue_ << std::endl;
-    std::cout << "Lesson: " << lesson_ << std::endl;
-    std::cout << "Difficulty: " << difficulty_ << std::endl;
+    std::cout << "Part of Speech: " << getPartOfSpeech() << std::endl;
+    std::cout << "Dialogue: " << getDialogue() << std::endl;
+    std::cout << "Lesson: " << getLesson() << std::endl;
+    std::cout << "Difficulty: " << getDifficulty() << std::endl;
 }
 
 std::string Vocab::correctAnswer() const {
+    const std::vector<std::string> english = getEnglish();
     std::stringstream ss;
-    for (size_t i = 0; i < english_.size(); ++i) {
+    for (size_t i = 0; i < english.size(); ++i) {
         if (i > 0) ss << ", ";
-        ss << english_[i];
+        ss << english[i];
     }
     return ss.str();
 }
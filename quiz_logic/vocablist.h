@@ -0,0 +1,175 @@
+#ifndef VOCABLIST_H_
+#define VOCABLIST_H_
+
+#include <string>
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <initializer_list>
+#include <cstddef>
+#include <cstdint>
+
+#include "vocab.h"
+#include "flatarray.h"
+
+/**
+ * @brief A deck's items as three flat arrays: a VocabRecord per item, the
+ *        English meanings, and every string back to back.
+ *
+ * Items are handed out by value as Vocab views of those arrays, which copy
+ * nothing until a field is set, so a list viewing a mapped DeckImage serves
+ * every item from the shared pages. A view is valid while its list is alive
+ * and unchanged: like an iterator, push_back() and clear() invalidate it.
+ */
+class VocabList {
+public:
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Vocab value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Vocab* pointer;
+        typedef Vocab reference;
+
+        const_iterator(const VocabList* list, size_t index) : list_(list), index_(index) {}
+        Vocab operator*() const { return (*list_)[index_]; }
+        const_iterator& operator++() { ++index_; return *this; }
+        const_iterator operator++(int) { const_iterator previous = *this; ++index_; return previous; }
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const VocabList* list_;
+        size_t index_;
+    };
+
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    VocabList() = default;
+    VocabList(const std::vector<Vocab>& items);
+    VocabList(std::initializer_list<Vocab> items);
+
+    /** @brief A list over arrays it does not own, e.g. a mapped image's sections. */
+    static VocabList view(FlatArray<VocabRecord> records, FlatArray<VocabText> english, FlatArray<char> strings);
+
+    size_t size() const { return records_.size(); }
+    bool empty() const { return records_.empty(); }
+    Vocab operator[](size_t i) const { return Vocab(&records_[i], english_.data(), strings_.data()); }
+    Vocab front() const { return (*this)[0]; }
+    Vocab back() const { return (*this)[size() - 1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    /** @brief Appends a copy of vocab; a viewed list is copied into its own arrays first. */
+    void push_back(const Vocab& vocab);
+    void clear();
+    void reserve(size_t count) { records_.edit().reserve(count); }
+
+    /** @return The index of a view of this list's items, or NOT_FOUND for any other Vocab. */
+    size_t indexOf(const Vocab& vocab) const;
+
+    /** @return True if every record's strings and meanings lie inside the arrays. */
+    bool consistent() const;
+
+    const FlatArray<VocabRecord>& records() const { return records_; }
+    const FlatArray<VocabText>& english() const { return english_; }
+    const FlatArray<char>& strings() const { return strings_; }
+
+private:
+    static VocabText addText(std::vector<char>& strings, const std::string& value);
+    bool inStrings(const VocabText& ref) const {
+        return static_cast<size_t>(ref.offset) + ref.length <= strings_.size();
+    }
+
+    FlatArray<VocabRecord> records_;
+    FlatArray<VocabText> english_;
+    FlatArray<char> strings_;
+};
+
+const size_t VocabList::NOT_FOUND;
+
+VocabList::VocabList(const std::vector<Vocab>& items) {
+    reserve(items.size());
+    for (const auto& vocab : items) {
+        push_back(vocab);
+    }
+}
+
+VocabList::VocabList(std::initializer_list<Vocab> items) {
+    reserve(items.size());
+    for (const auto& vocab : items) {
+        push_back(vocab);
+    }
+}
+
+VocabList VocabList::view(FlatArray<VocabRecord> records, FlatArray<VocabText> english, FlatArray<char> strings) {
+    VocabList list;
+    list.records_ = std::move(records);
+    list.english_ = std::move(english);
+    list.strings_ = std::move(strings);
+    return list;
+}
+
+VocabText VocabList::addText(std::vector<char>& strings, const std::string& value) {
+    VocabText ref = { static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size()) };
+    strings.insert(strings.end(), value.begin(), value.end());
+    return ref;
+}
+
+void VocabList::push_back(const Vocab& vocab) {
+    // Read everything first: vocab may be a view of this list's arrays.
+    const std::string kanji = vocab.getKanji();
+    const std::string hiragana = vocab.getHiragana();
+    const std::string romaji = vocab.getRomaji();
+    const std::vector<std::string> meanings = vocab.getEnglish();
+    const std::string partOfSpeech = vocab.getPartOfSpeech();
+    const std::string dialogue = vocab.getDialogue();
+    const std::string lesson = vocab.getLesson();
+
+    std::vector<char>& strings = strings_.edit();
+    std::vector<VocabText>& english = english_.edit();
+    VocabRecord record;
+    record.kanji = addText(strings, kanji);
+    record.hiragana = addText(strings, hiragana);
+    record.romaji = addText(strings, romaji);
+    record.partOfSpeech = addText(strings, partOfSpeech);
+    record.dialogue = addText(strings, dialogue);
+    record.lesson = addText(strings, lesson);
+    record.english = static_cast<uint32_t>(english.size());
+    for (const auto& meaning : meanings) {
+        english.push_back(addText(strings, meaning));
+    }
+    record.englishCount = static_cast<uint32_t>(meanings.size());
+    record.difficulty = vocab.getDifficulty();
+    records_.edit().push_back(record);
+}
+
+void VocabList::clear() {
+    records_.edit().clear();
+    english_.edit().clear();
+    strings_.edit().clear();
+}
+
+size_t VocabList::indexOf(const Vocab& vocab) const {
+    std::less<const VocabRecord*> before;
+    if (!vocab.record_ || before(vocab.record_, records_.begin()) || !before(vocab.record_, records_.end())) {
+        return NOT_FOUND;
+    }
+    return static_cast<size_t>(vocab.record_ - records_.begin());
+}
+
+bool VocabList::consistent() const {
+    for (const VocabText& meaning : english_) {
+        if (!inStrings(meaning)) return false;
+    }
+    for (const VocabRecord& record : records_) {
+        if (static_cast<size_t>(record.english) + record.englishCount > english_.size() ||
+            !inStrings(record.kanji) || !inStrings(record.hiragana) || !inStrings(record.romaji) ||
+            !inStrings(record.partOfSpeech) || !inStrings(record.dialogue) || !inStrings(record.lesson)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif  // VOCABLIST_H_
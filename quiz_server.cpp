@@ -0,0 +1,492 @@
+///////////////////////////////////////////////////////////////////////////////
+///             Quiz server
+///
+///
+/// Hosts the quiz for many learners at once. Every TCP connection is one
+/// learner with its own QuizSession and LearnerState; all of them quiz on
+/// the same read-only Deck. Given a deck image (--deck quiz_data.deck, see
+/// compile_deck.cpp) the server maps it, and servers started on the same
+/// image share its pages.
+///
+/// The deck files are watched (DeckWatcher): an edited deck is rebuilt in
+/// the background and published. A learner moves to it at their next
+/// "start", with their history remapped; the session already running keeps
+/// the deck it started on. Answering never touches the published deck.
+///
+/// One command per line, one JSON object per reply line:
+///
+///   types                  {"types":["Kanji to Hiragana",...]}
+///   start <type> [count]   {"question":"...","number":1,"of":10}
+///                          type is the menu number, 1-7 (listening needs audio)
+///   answer <text>          {"result":"correct","answer":"...","question":...}
+///                          after the last question "done":true with the score
+///   stats                  {"correct":3,"total":5,"recall":0.7}
+///   quit                   {"bye":true,...}, then the server closes
+///
+///   Anything else, or an answer without a question: {"error":"..."}
+///   An unusable answer: {"result":"invalid","message":"..."}
+///
+/// One thread runs a non-blocking epoll loop that accepts connections and
+/// reads them. Complete lines go to a pool of workers, each connection to
+/// one worker at a time so its replies keep their order. Workers send the
+/// replies themselves and leave what the socket does not take to the loop.
+///
+/// Usage:   ./quiz_server [--port 50124] [--workers N] [--deck quiz_data.json|.deck]
+///                        [--sentences sentences.tsv] [--kradfile kradfile-u]
+///
+/// @see     quiz_load.cpp
+///
+/// @file    quiz_server.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <random>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <nlohmann/json.hpp>
+#include "quiz_logic/quiz.h"
+
+using json = nlohmann::json;
+
+struct ServerOptions {
+    int port = 50124;
+    unsigned workers = std::max(2u, std::thread::hardware_concurrency());
+    std::string deckFile = "quiz_data.json";
+    std::string sentenceFile = "sentences.tsv";
+    std::string kradFile = "kradfile-u";
+};
+
+// A line longer than this is not a command; the connection is dropped.
+static const size_t MAX_LINE_BYTES = 4096;
+// Replies a client leaves unread beyond this get it disconnected.
+static const size_t MAX_OUTPUT_BYTES = 1 << 20;
+
+struct Connection {
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { close(fd); }
+
+    const int fd;
+    std::string input;  // loop thread only
+
+    std::mutex mutex;
+    std::deque<std::string> lines;  // received, not yet handled
+    std::string output;             // replies the socket has not taken yet
+    bool busy = false;              // queued for or held by a worker
+    bool writeWanted = false;       // EPOLLOUT is registered
+    bool closing = false;           // shut down once output is sent
+
+    // Only touched by the worker holding the connection (busy).
+    std::unique_ptr<QuizSession> session;
+    LearnerState learner;  // carried from one session to the next
+    std::shared_ptr<const Deck> deck;  // what learner refers to
+    uint64_t deckVersion = 0;
+    bool quit = false;
+};
+
+typedef std::shared_ptr<Connection> ConnectionPtr;
+
+static ServerOptions options;
+static std::unique_ptr<DeckWatcher> decks;
+static int epollFd = -1;
+static volatile std::sig_atomic_t stopping = 0;
+static std::atomic<uint64_t> commandsHandled(0);
+
+static void onSignal(int) { stopping = 1; }
+
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void watch(int fd, uint32_t events, int op) {
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, op, fd, &event);
+}
+
+static std::string dumpLine(const json& reply) {
+    return reply.dump(-1, ' ', false, json::error_handler_t::replace) + "\n";
+}
+
+// Sends what the socket takes; the caller holds connection.mutex.
+static void flush(Connection& connection) {
+    while (!connection.output.empty()) {
+        ssize_t n = send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            connection.output.clear();
+            connection.closing = true;
+            break;
+        }
+        connection.output.erase(0, static_cast<size_t>(n));
+    }
+
+    if (connection.output.size() > MAX_OUTPUT_BYTES) {
+        connection.output.clear();
+        connection.closing = true;
+    }
+    bool wantWrite = !connection.output.empty();
+    if (wantWrite != connection.writeWanted) {
+        watch(connection.fd, wantWrite ? EPOLLIN | EPOLLOUT : EPOLLIN, EPOLL_CTL_MOD);
+        connection.writeWanted = wantWrite;
+    }
+    // The loop sees the hangup and forgets the connection.
+    if (connection.closing && connection.output.empty()) {
+        shutdown(connection.fd, SHUT_RDWR);
+    }
+}
+
+/**
+ * @brief Connections with lines to handle. A connection is in here at most
+ *        once (Connection::busy); a null entry stops a worker.
+ */
+class WorkQueue {
+public:
+    void push(ConnectionPtr connection) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(connection));
+        }
+        ready_.notify_one();
+    }
+
+    ConnectionPtr pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [&] { return !queue_.empty(); });
+        ConnectionPtr connection = std::move(queue_.front());
+        queue_.pop_front();
+        return connection;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<ConnectionPtr> queue_;
+};
+
+static WorkQueue work;
+
+// Draws until a question can be asked or the session is over.
+static void askNext(QuizSession& session, json& reply) {
+    while (!session.finished()) {
+        const SessionQuestion& question = session.nextQuestion();
+        if (!question.prompt.empty()) {
+            reply["question"] = question.prompt;
+            reply["number"] = session.asked();
+            reply["of"] = session.questionCount();
+            return;
+        }
+    }
+    reply["done"] = true;
+    reply["correct"] = session.learner().correctAnswers;
+    reply["total"] = session.learner().totalQuestions;
+}
+
+static json start(Connection& connection, std::istringstream& arguments) {
+    int type = 0;
+    size_t count = 10;
+    arguments >> type;
+    if (!(arguments >> count)) count = 10;
+
+    const std::vector<std::string>& types = QuizSession::testTypes();
+    if (type < 1 || type > static_cast<int>(types.size())) {
+        return { { "error", "Invalid test type." } };
+    }
+    if (types[type - 1] == "Listening Comprehension") {
+        return { { "error", "Listening comprehension needs audio; the server has none." } };
+    }
+    if (count == 0 || count > 1000) {
+        return { { "error", "Question count must be between 1 and 1000." } };
+    }
+
+    static thread_local std::mt19937 seeds(std::random_device{}());
+    if (connection.session) {
+        connection.learner = connection.session->learner();
+    }
+    // Move to the latest deck only when it changed; usually this is one atomic load.
+    uint64_t version = decks->version();
+    if (!connection.deck || version != connection.deckVersion) {
+        std::shared_ptr<const Deck> latest = decks->current();
+        if (connection.deck) {
+            connection.learner.remap(*connection.deck, *latest);
+        }
+        connection.deck = latest;
+        connection.deckVersion = version;
+    }
+    connection.session.reset(new QuizSession(connection.deck, types[type - 1], count, connection.learner, seeds()));
+    if (!connection.session->error().empty()) {
+        json reply = { { "error", connection.session->error() } };
+        connection.session.reset();
+        return reply;
+    }
+
+    json reply = json::object();
+    askNext(*connection.session, reply);
+    return reply;
+}
+
+static json answer(Connection& connection, const std::string& text) {
+    if (!connection.session || !connection.session->pending()) {
+        return { { "error", "No question to answer." } };
+    }
+    QuizSession& session = *connection.session;
+    AnswerResult result = session.submitAnswer(text);
+    if (result.status == AnswerStatus::Invalid) {
+        return { { "result", "invalid" }, { "message", result.message } };
+    }
+
+    json reply = {
+        { "result", result.status == AnswerStatus::Correct ? "correct" : "incorrect" },
+        { "answer", session.current().correctAnswer }
+    };
+    askNext(session, reply);
+    return reply;
+}
+
+static json stats(const Connection& connection) {
+    const LearnerState& learner = connection.session ? connection.session->learner() : connection.learner;
+    return {
+        { "correct", learner.correctAnswers },
+        { "total", learner.totalQuestions },
+        { "recall", learner.model.predictRecall(0) }
+    };
+}
+
+static std::string handle(Connection& connection, const std::string& line) {
+    std::istringstream arguments(line);
+    std::string command;
+    arguments >> command;
+
+    json reply;
+    if (command == "types") {
+        reply["types"] = QuizSession::testTypes();
+    } else if (command == "start") {
+        reply = start(connection, arguments);
+    } else if (command == "answer") {
+        std::string text;
+        std::getline(arguments, text);
+        if (QuizSession::toLowercaseAndTrim(text) == "q" || QuizSession::toLowercaseAndTrim(text) == "quit") {
+            command = "quit";
+        } else {
+            reply = answer(connection, text);
+        }
+    } else if (command == "stats") {
+        reply = stats(connection);
+    } else if (!command.empty() && command != "quit") {
+        reply["error"] = "Unknown command: " + command;
+    }
+
+    if (command == "quit") {
+        reply = stats(connection);
+        reply["bye"] = true;
+        connection.quit = true;
+    }
+    ++commandsHandled;
+    return reply.is_null() ? std::string() : dumpLine(reply);
+}
+
+static void workerLoop() {
+    while (ConnectionPtr connection = work.pop()) {
+        std::deque<std::string> lines;
+        bool closing;
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            lines.swap(connection->lines);
+            closing = connection->closing;
+        }
+
+        std::string replies;
+        for (const auto& line : lines) {
+            if (closing || connection->quit) break;
+            replies += handle(*connection, line);
+        }
+
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        connection->output += replies;
+        connection->closing = connection->closing || connection->quit;
+        flush(*connection);
+        if (connection->lines.empty() || connection->closing) {
+            connection->busy = false;
+        } else {
+            work.push(connection);
+        }
+    }
+}
+
+// Reads what is there; false once the peer is gone.
+static bool readLines(const ConnectionPtr& connection) {
+    bool open = true;
+    std::vector<std::string> lines;
+    while (true) {
+        char chunk[4096];
+        ssize_t n = recv(connection->fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            connection->input.append(chunk, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) open = false;
+        break;
+    }
+
+    size_t begin = 0, end;
+    while ((end = connection->input.find('\n', begin)) != std::string::npos) {
+        size_t length = end - begin;
+        if (length > 0 && connection->input[end - 1] == '\r') --length;
+        lines.push_back(connection->input.substr(begin, length));
+        begin = end + 1;
+    }
+    connection->input.erase(0, begin);
+    if (connection->input.size() > MAX_LINE_BYTES) return false;
+    if (lines.empty()) return open;
+
+    std::lock_guard<std::mutex> lock(connection->mutex);
+    for (auto& line : lines) connection->lines.push_back(std::move(line));
+    if (!connection->busy) {
+        connection->busy = true;
+        work.push(connection);
+    }
+    return open;
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--port") options.port = std::stoi(value);
+        else if (flag == "--workers") options.workers = std::max(1, std::stoi(value));
+        else if (flag == "--deck") options.deckFile = value;
+        else if (flag == "--sentences") options.sentenceFile = value;
+        else if (flag == "--kradfile") options.kradFile = value;
+        else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Quiz builds the deck the way the terminal quiz does, and rebuilds it
+    // the same way whenever one of its files changes.
+    auto load = []() { return Quiz::buildDeck(options.deckFile, options.sentenceFile, options.kradFile); };
+    std::shared_ptr<const Deck> deck = load();
+    if (!deck) {
+        return 1;
+    }
+    std::vector<std::string> deckFiles = { options.deckFile, options.sentenceFile, options.kradFile };
+    if (Deck::imageFileFor(options.deckFile) != options.deckFile) {
+        deckFiles.push_back(Deck::imageFileFor(options.deckFile));
+    }
+    decks.reset(new DeckWatcher(deck, deckFiles, load));
+    decks->setReloadListener([](uint64_t version, const Deck& reloaded) {
+        std::cout << "Deck reloaded: version " << version << ", " << reloaded.items.size() << " items" << std::endl;
+    });
+    decks->start();
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on 127.0.0.1:" << options.port << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    setNonBlocking(listener);
+
+    epollFd = epoll_create1(0);
+    watch(listener, EPOLLIN, EPOLL_CTL_ADD);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < options.workers; ++i) {
+        workers.emplace_back(workerLoop);
+    }
+
+    std::cout << "Quiz server listening on 127.0.0.1:" << options.port << " (" << deck->items.size()
+              << " items, " << options.workers << " workers)" << std::endl;
+
+    std::map<int, ConnectionPtr> connections;
+    uint64_t accepted = 0;
+    size_t peak = 0;
+    std::vector<epoll_event> events(1024);
+    while (!stopping) {
+        int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listener) {
+                int client;
+                while ((client = accept(listener, nullptr, nullptr)) >= 0) {
+                    setNonBlocking(client);
+                    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                    connections[client] = std::make_shared<Connection>(client);
+                    watch(client, EPOLLIN, EPOLL_CTL_ADD);
+                    ++accepted;
+                }
+                peak = std::max(peak, connections.size());
+                continue;
+            }
+
+            auto found = connections.find(fd);
+            if (found == connections.end()) continue;
+            ConnectionPtr connection = found->second;
+
+            bool open = !(events[i].events & EPOLLERR);
+            if (open && (events[i].events & EPOLLOUT)) {
+                std::lock_guard<std::mutex> lock(connection->mutex);
+                flush(*connection);
+            }
+            if (open && (events[i].events & (EPOLLIN | EPOLLHUP))) {
+                open = readLines(connection);
+            }
+            if (!open) {
+                // A worker may still hold it; the socket closes with the last reference.
+                watch(fd, 0, EPOLL_CTL_DEL);
+                connections.erase(found);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        work.push(nullptr);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    decks->stop();
+    std::cout << "\n" << accepted << " connections (" << peak << " at once), "
+              << commandsHandled.load() << " commands, deck version " << decks->version() << "." << std::endl;
+    connections.clear();
+    close(epollFd);
+    close(listener);
+    return 0;
+}
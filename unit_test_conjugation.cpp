@@ -0,0 +1,135 @@
+#include "gtest/gtest.h"
+#include "quiz_logic/conjugation.h"
+
+class ConjugationTest : public ::testing::Test {
+protected:
+    Vocab makeVocab(const std::string& kanji, const std::string& hiragana, const std::string& partOfSpeech) {
+        Vocab vocab;
+        vocab.setKanji(kanji);
+        vocab.setHiragana(hiragana);
+        vocab.setPartOfSpeech(partOfSpeech);
+        return vocab;
+    }
+
+    std::vector<std::string> forms(const std::string& hiragana, WordClass wordClass) {
+        std::string out[ConjugationTable::FORM_COUNT];
+        EXPECT_TRUE(ConjugationTable::conjugate(hiragana, wordClass, out));
+        return std::vector<std::string>(out, out + ConjugationTable::FORM_COUNT);
+    }
+};
+
+TEST_F(ConjugationTest, Classify) {
+    EXPECT_EQ(ConjugationTable::classify("noun", "ともだち"), WordClass::None);
+    EXPECT_EQ(ConjugationTable::classify("ru-verb", "たべる"), WordClass::Ichidan);
+    EXPECT_EQ(ConjugationTable::classify("u-verb", "かえる"), WordClass::Godan);
+    EXPECT_EQ(ConjugationTable::classify("verb", "みる"), WordClass::Ichidan);
+    EXPECT_EQ(ConjugationTable::classify("verb", "のむ"), WordClass::Godan);
+    EXPECT_EQ(ConjugationTable::classify("irregular verb", "べんきょうする"), WordClass::Suru);
+    EXPECT_EQ(ConjugationTable::classify("irregular verb", "くる"), WordClass::Kuru);
+    EXPECT_EQ(ConjugationTable::classify("i-adjective", "たかい"), WordClass::IAdjective);
+    EXPECT_EQ(ConjugationTable::classify("na-adjective", "きれい"), WordClass::NaAdjective);
+    EXPECT_EQ(ConjugationTable::classify("adverb", "よく"), WordClass::None);
+    EXPECT_EQ(ConjugationTable::classify("adverb", "もう"), WordClass::None);
+    EXPECT_EQ(ConjugationTable::classify("verbal noun", "べんきょう"), WordClass::None);
+}
+
+TEST_F(ConjugationTest, GodanVerbsThatLookIchidan) {
+    struct Case { const char* kanji; const char* hiragana; const char* te; const char* negative; };
+    const Case godan[] = {
+        { "帰る", "かえる", "かえって", "かえらない" },
+        { "入る", "はいる", "はいって", "はいらない" },
+        { "知る", "しる", "しって", "しらない" },
+        { "走る", "はしる", "はしって", "はしらない" },
+        { "切る", "きる", "きって", "きらない" },
+        { "要る", "いる", "いって", "いらない" },
+        { "持ち帰る", "もちかえる", "もちかえって", "もちかえらない" }
+    };
+    for (const Case& c : godan) {
+        EXPECT_EQ(ConjugationTable::classify("verb", c.hiragana, c.kanji), WordClass::Godan) << c.kanji;
+        std::vector<std::string> out = forms(c.hiragana, WordClass::Godan);
+        EXPECT_EQ(out[0], c.te);
+        EXPECT_EQ(out[2], c.negative);
+    }
+
+    // Their ichidan homophones stay ichidan; kana alone cannot tell きる apart.
+    EXPECT_EQ(ConjugationTable::classify("verb", "かえる", "変える"), WordClass::Ichidan);
+    EXPECT_EQ(ConjugationTable::classify("verb", "きる", "着る"), WordClass::Ichidan);
+    EXPECT_EQ(ConjugationTable::classify("verb", "いる", "居る"), WordClass::Ichidan);
+    EXPECT_EQ(ConjugationTable::classify("verb", "はいる"), WordClass::Godan);
+    EXPECT_EQ(ConjugationTable::classify("verb", "きる"), WordClass::Ichidan);
+
+    ConjugationTable table;
+    std::vector<Vocab> deck = { makeVocab("帰る", "かえる", "verb"), makeVocab("よく", "よく", "adverb") };
+    EXPECT_EQ(table.build(deck), 1u);
+    EXPECT_EQ(table.form(deck[0], ConjugationForm::Polite).str(), "かえります");
+    EXPECT_FALSE(table.hasForms(deck[1]));
+}
+
+TEST_F(ConjugationTest, GodanRows) {
+    EXPECT_EQ(forms("かく", WordClass::Godan), (std::vector<std::string>{"かいて", "かいた", "かかない", "かきます"}));
+    EXPECT_EQ(forms("のむ", WordClass::Godan), (std::vector<std::string>{"のんで", "のんだ", "のまない", "のみます"}));
+    EXPECT_EQ(forms("かう", WordClass::Godan), (std::vector<std::string>{"かって", "かった", "かわない", "かいます"}));
+    EXPECT_EQ(forms("はなす", WordClass::Godan), (std::vector<std::string>{"はなして", "はなした", "はなさない", "はなします"}));
+    EXPECT_EQ(forms("いく", WordClass::Godan), (std::vector<std::string>{"いって", "いった", "いかない", "いきます"}));
+    EXPECT_EQ(forms("ある", WordClass::Godan)[2], "ない");
+}
+
+TEST_F(ConjugationTest, IrregularsAndAdjectives) {
+    EXPECT_EQ(forms("たべる", WordClass::Ichidan), (std::vector<std::string>{"たべて", "たべた", "たべない", "たべます"}));
+    EXPECT_EQ(forms("する", WordClass::Suru), (std::vector<std::string>{"して", "した", "しない", "します"}));
+    EXPECT_EQ(forms("くる", WordClass::Kuru), (std::vector<std::string>{"きて", "きた", "こない", "きます"}));
+    EXPECT_EQ(forms("たかい", WordClass::IAdjective), (std::vector<std::string>{"たかくて", "たかかった", "たかくない", "たかいです"}));
+    EXPECT_EQ(forms("いい", WordClass::IAdjective)[1], "よかった");
+    EXPECT_EQ(forms("しずか", WordClass::NaAdjective)[2], "しずかじゃない");
+}
+
+TEST_F(ConjugationTest, NaAdjectivesEndingInI) {
+    EXPECT_EQ(ConjugationTable::classify("adjective", "きれい", "綺麗"), WordClass::NaAdjective);
+    EXPECT_EQ(ConjugationTable::classify("adjective", "ゆうめい", "有名"), WordClass::NaAdjective);
+    EXPECT_EQ(ConjugationTable::classify("adjective", "きらい"), WordClass::NaAdjective);
+    EXPECT_EQ(ConjugationTable::classify("adjective", "とくい"), WordClass::NaAdjective);
+    EXPECT_EQ(ConjugationTable::classify("adjective", "ていねい", "丁寧"), WordClass::NaAdjective);
+    EXPECT_EQ(ConjugationTable::classify("adjective", "たかい", "高い"), WordClass::IAdjective);
+    EXPECT_EQ(ConjugationTable::classify("adj-i", "きれい"), WordClass::IAdjective);  // the tag wins
+
+    ConjugationTable table;
+    std::vector<Vocab> deck = { makeVocab("綺麗", "きれい", "adjective"), makeVocab("有名", "ゆうめい", "adjective") };
+    EXPECT_EQ(table.build(deck), 2u);
+    EXPECT_EQ(table.form(deck[0], ConjugationForm::Te).str(), "きれいで");
+    EXPECT_EQ(table.form(deck[0], ConjugationForm::Past).str(), "きれいだった");
+    EXPECT_EQ(table.form(deck[0], ConjugationForm::Negative).str(), "きれいじゃない");
+    EXPECT_EQ(table.form(deck[1], ConjugationForm::Te).str(), "ゆうめいで");
+}
+
+TEST_F(ConjugationTest, CompoundsOfKuru) {
+    EXPECT_EQ(ConjugationTable::classify("verb", "もってくる", "持って来る"), WordClass::Kuru);
+    EXPECT_EQ(ConjugationTable::classify("verb", "もってくる"), WordClass::Kuru);
+    EXPECT_EQ(ConjugationTable::classify("verb", "つれてくる", "連れて来る"), WordClass::Kuru);
+    EXPECT_EQ(ConjugationTable::classify("u-verb", "つくる", "作る"), WordClass::Godan);
+    EXPECT_EQ(ConjugationTable::classify("verb", "めくる"), WordClass::Godan);
+    EXPECT_EQ(ConjugationTable::classify("verb", "できる", "出来る"), WordClass::Ichidan);
+    EXPECT_EQ(forms("もってくる", WordClass::Kuru),
+              (std::vector<std::string>{"もってきて", "もってきた", "もってこない", "もってきます"}));
+}
+
+TEST_F(ConjugationTest, CompoundsOfIi) {
+    EXPECT_EQ(forms("かっこいい", WordClass::IAdjective),
+              (std::vector<std::string>{"かっこよくて", "かっこよかった", "かっこよくない", "かっこいいです"}));
+    EXPECT_EQ(forms("いい", WordClass::IAdjective)[0], "よくて");
+    EXPECT_EQ(forms("かわいい", WordClass::IAdjective)[0], "かわいくて");
+}
+
+TEST_F(ConjugationTest, PrecomputedTable) {
+    std::vector<Vocab> deck = {
+        makeVocab("友達", "ともだち", "noun"),
+        makeVocab("食べる", "たべる", "ru-verb"),
+        makeVocab("高い", "たかい", "i-adjective")
+    };
+
+    ConjugationTable table;
+    EXPECT_EQ(table.build(deck), 2u);
+    EXPECT_FALSE(table.hasForms(deck[0]));
+    EXPECT_TRUE(table.form(deck[1], ConjugationForm::Polite).equals("たべます"));
+    EXPECT_EQ(table.form(deck[2], ConjugationForm::Negative).str(), "たかくない");
+    EXPECT_EQ(table.conjugableItems(), (std::vector<size_t>{1, 2}));
+}
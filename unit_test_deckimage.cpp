@@ -0,0 +1,216 @@
+#include "gtest/gtest.h"
+#include "quiz_logic/quizsession.h"
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+class DeckImageTest : public ::testing::Test {
+protected:
+    Deck deck;
+    const std::string corpusFile = "test_sentences.tsv";
+    const std::string kradFile = "test_kradfile";
+    const std::string imageFile = "test_deck.deck";
+
+    void addItem(const std::string& kanji, const std::string& hiragana, const std::vector<std::string>& english,
+                 const std::string& partOfSpeech = "noun") {
+        Vocab vocab;
+        vocab.setKanji(kanji);
+        vocab.setHiragana(hiragana);
+        vocab.setRomaji("romaji");
+        vocab.setEnglish(english);
+        vocab.setPartOfSpeech(partOfSpeech);
+        vocab.setLesson("1");
+        vocab.setDifficulty(2.5);
+        deck.items.push_back(vocab);
+    }
+
+    void SetUp() override {
+        addItem("歴史", "れきし", { "history" });
+        addItem("友達", "ともだち", { "friend", "companion" });
+        addItem("食べる", "たべる", { "to eat" }, "ru-verb");
+
+        std::ofstream corpus(corpusFile);
+        corpus << "歴史が好きです。\tI like history.\n";
+        corpus << "友達と食べる。\tI eat with a friend.\n";
+        corpus.close();
+
+        std::ofstream krad(kradFile);
+        krad << "歴 : 厂 止 木\n";
+        krad << "暦 : 厂 日 木\n";
+        krad << "史 : 口 乂\n";
+        krad << "吏 : 口 乂 一\n";
+        krad.close();
+
+        deck.conjugations.build(deck.items);
+        deck.sentences.build(deck.items, corpusFile);
+        deck.kanji.loadKradfile(kradFile);
+        deck.kanji.buildSimilar(deck.items);
+    }
+
+    /** @brief Overwrites the index-th u32 of a section in the compiled image. */
+    void patch(DeckSection id, size_t index, uint32_t value) {
+        std::fstream file(imageFile, std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t header[4];
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+        for (uint32_t i = 0; i < header[2]; ++i) {
+            DeckImage::SectionEntry entry;
+            file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+            if (entry.id == static_cast<uint32_t>(id)) {
+                file.seekp(static_cast<std::streamoff>(entry.offset + index * sizeof(uint32_t)));
+                file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+                return;
+            }
+        }
+        FAIL() << "no section " << static_cast<uint32_t>(id);
+    }
+
+    void TearDown() override {
+        std::remove(corpusFile.c_str());
+        std::remove(kradFile.c_str());
+        std::remove(imageFile.c_str());
+    }
+};
+
+TEST_F(DeckImageTest, RoundTrip) {
+    std::string error;
+    ASSERT_TRUE(deck.compile(imageFile, &error)) << error;
+    std::shared_ptr<Deck> mapped = Deck::open(imageFile);
+    ASSERT_NE(mapped, nullptr);
+
+    ASSERT_EQ(mapped->items.size(), 3u);
+    EXPECT_EQ(mapped->items[1].getKanji(), "友達");
+    EXPECT_EQ(mapped->items[1].getEnglish(), (std::vector<std::string>{ "friend", "companion" }));
+    EXPECT_DOUBLE_EQ(mapped->items[2].getDifficulty(), 2.5);
+
+    EXPECT_EQ(mapped->conjugations.conjugableItems(), deck.conjugations.conjugableItems());
+    EXPECT_EQ(mapped->conjugations.form(mapped->items[2], ConjugationForm::Te).str(), "たべて");
+
+    EXPECT_EQ(mapped->sentences.sentenceCount(), deck.sentences.sentenceCount());
+    const SentencePosting& posting = mapped->sentences.posting(mapped->items[0], 0);
+    EXPECT_EQ(mapped->sentences.sentence(posting).english, "I like history.");
+    EXPECT_EQ(mapped->sentences.blankSentence(posting), "＿＿＿が好きです。");
+
+    EXPECT_EQ(mapped->kanji.kanjiCount(), 4u);
+    EXPECT_EQ(mapped->kanji.componentCount(), deck.kanji.componentCount());
+    EXPECT_DOUBLE_EQ(mapped->kanji.similarity("歴", "暦"), 0.5);
+    EXPECT_EQ(mapped->kanji.confusableVariants("歴史", 3), deck.kanji.confusableVariants("歴史", 3));
+}
+
+TEST_F(DeckImageTest, IndicesReadInPlace) {
+    ASSERT_TRUE(deck.compile(imageFile));
+    std::shared_ptr<Deck> mapped = Deck::open(imageFile);
+    ASSERT_NE(mapped, nullptr);
+
+    // A copy shares the mapping; changing it moves only the copy off the image.
+    Deck copy = *mapped;
+    mapped.reset();
+    EXPECT_EQ(copy.conjugations.form(copy.items[2], ConjugationForm::Past).str(), "たべた");
+    copy.conjugations.build(copy.items);
+    EXPECT_EQ(copy.conjugations.form(copy.items[2], ConjugationForm::Past).str(), "たべた");
+}
+
+TEST_F(DeckImageTest, ItemsAreViewsOfTheImage) {
+    ASSERT_TRUE(deck.compile(imageFile));
+    std::shared_ptr<Deck> mapped = Deck::open(imageFile);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_TRUE(mapped->items.records().isView());
+    EXPECT_TRUE(mapped->items.strings().isView());
+
+    Vocab item = mapped->items[1];
+    EXPECT_EQ(mapped->indexOf(item), 1u);
+    EXPECT_EQ(mapped->conjugations.form(item, ConjugationForm::Te).str(), "");
+    EXPECT_EQ(mapped->sentences.postingCount(item), mapped->sentences.postingCount(1));
+
+    // Setting a field copies that Vocab off the image and leaves the deck alone.
+    item.setKanji("友人");
+    EXPECT_EQ(item.getHiragana(), "ともだち");
+    EXPECT_EQ(mapped->indexOf(item), Deck::NOT_FOUND);
+    EXPECT_EQ(mapped->items[1].getKanji(), "友達");
+}
+
+TEST_F(DeckImageTest, SessionsRunOnTheImage) {
+    ASSERT_TRUE(deck.compile(imageFile));
+    std::shared_ptr<const Deck> mapped = Deck::open(imageFile);
+    ASSERT_NE(mapped, nullptr);
+
+    QuizSession session(mapped, "Fill in the Blank", 2, LearnerState(), 1);
+    ASSERT_TRUE(session.error().empty());
+    const SessionQuestion& question = session.nextQuestion();
+    EXPECT_NE(question.prompt.find("＿＿＿"), std::string::npos);
+    EXPECT_EQ(session.submitAnswer(mapped->items[question.item].getHiragana()).status, AnswerStatus::Correct);
+}
+
+TEST_F(DeckImageTest, RejectsOtherFiles) {
+    std::ofstream(imageFile) << "not an image";
+    EXPECT_EQ(Deck::open(imageFile), nullptr);
+    EXPECT_EQ(Deck::open("missing.deck"), nullptr);
+    EXPECT_EQ(Deck::imageFileFor("quiz_data.json"), "quiz_data.deck");
+    EXPECT_EQ(Deck::imageFileFor("./decks/n5"), "./decks/n5.deck");
+}
+
+TEST_F(DeckImageTest, RejectsOffsetsOutsideTheirSections) {
+    const std::vector<std::pair<DeckSection, std::pair<size_t, uint32_t>>> corruptions = {
+        { DeckSection::Items, { 0, 100000 } },                // kanji string past the pool
+        { DeckSection::English, { 1, 100000 } },              // meaning length past the pool
+        { DeckSection::ConjugationOffsets, { 1, 100000 } },   // form past the pool
+        { DeckSection::ConjugationOffsets, { 0, 1 } },        // rows not starting at 0
+        { DeckSection::ConjugationItems, { 0, 3 } },          // item id past the deck
+        { DeckSection::SentencePostings, { 0, 99 } },         // sentence id past the sentences
+        { DeckSection::SentencePostings, { 2, 100000 } },     // surface form past the sentence
+        { DeckSection::Sentences, { 1, 100000 } },            // sentence text past the pool
+        { DeckSection::SentenceOffsets, { 1, 100 } },         // row past the postings
+        { DeckSection::KanjiRowIndex, { 1, 100 } },           // kanji row past the rows
+        { DeckSection::KanjiSimilarOffsets, { 1, 100 } },     // similar list past the lists
+        { DeckSection::KanjiSimilar, { 0, 0xD800 } },         // not a code point
+        { DeckSection::ItemKeys, { 2, 3 } },                  // key of an item past the deck
+    };
+    for (const auto& corruption : corruptions) {
+        ASSERT_TRUE(deck.compile(imageFile));
+        ASSERT_NE(Deck::open(imageFile), nullptr);
+        patch(corruption.first, corruption.second.first, corruption.second.second);
+        EXPECT_EQ(Deck::open(imageFile), nullptr) << "section " << static_cast<uint32_t>(corruption.first);
+    }
+}
+
+TEST_F(DeckImageTest, RejectsSectionsThatWrapPastTheEnd) {
+    ASSERT_TRUE(deck.compile(imageFile));
+    // Move the first section 16 bytes before 2^64 and make it 16 bytes
+    // longer: offset + bytes wraps around to its old end, inside the file.
+    std::fstream file(imageFile, std::ios::in | std::ios::out | std::ios::binary);
+    DeckImage::SectionEntry entry;
+    file.seekg(16);
+    file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+    entry.offset = 0xFFFFFFFFFFFFFFF0ULL;
+    entry.bytes += 16;
+    file.seekp(16);
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    file.close();
+    EXPECT_EQ(Deck::open(imageFile), nullptr);
+}
+
+TEST_F(DeckImageTest, ImageIsCurrentOnlyForTheSourceItWasCompiledFrom) {
+    const std::string sourceFile = "test_deck.json";
+    std::ofstream(sourceFile) << "[1]";
+    ASSERT_TRUE(deck.compile(imageFile, nullptr, sourceFile));
+    EXPECT_TRUE(Deck::imageIsCurrent(imageFile, sourceFile));
+
+    // Same size and second, another nanosecond: an edit right after compiling.
+    struct stat info;
+    ASSERT_EQ(stat(sourceFile.c_str(), &info), 0);
+    struct timespec times[2] = { info.st_atim, info.st_mtim };
+    times[1].tv_nsec = (times[1].tv_nsec + 1) % 1000000000;
+    ASSERT_EQ(utimensat(AT_FDCWD, sourceFile.c_str(), times, 0), 0);
+    EXPECT_FALSE(Deck::imageIsCurrent(imageFile, sourceFile));
+
+    // Same time, another size.
+    std::ofstream(sourceFile) << "[1, 2]";
+    times[1] = info.st_mtim;
+    ASSERT_EQ(utimensat(AT_FDCWD, sourceFile.c_str(), times, 0), 0);
+    EXPECT_FALSE(Deck::imageIsCurrent(imageFile, sourceFile));
+
+    ASSERT_TRUE(deck.compile(imageFile));
+    EXPECT_FALSE(Deck::imageIsCurrent(imageFile, sourceFile));
+    EXPECT_TRUE(Deck::imageIsCurrent(imageFile, "missing.json"));
+    std::remove(sourceFile.c_str());
+}
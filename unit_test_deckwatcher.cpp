@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "quiz_logic/quiz.h"
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+class DeckWatcherTest : public ::testing::Test {
+protected:
+    const std::string deckFile = "test_watched_deck.json";
+
+    void writeDeck(const std::vector<std::string>& kanji) {
+        nlohmann::json items = nlohmann::json::array();
+        for (const auto& word : kanji) {
+            Vocab vocab;
+            vocab.setKanji(word);
+            vocab.setHiragana("かな");
+            vocab.setEnglish({ "meaning" });
+            items.push_back(vocab.toJson());
+        }
+        // Written aside and renamed, as editors and compile_deck do.
+        std::ofstream(deckFile + ".new") << items;
+        std::rename((deckFile + ".new").c_str(), deckFile.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(deckFile.c_str());
+        std::remove((deckFile + ".new").c_str());
+    }
+};
+
+TEST_F(DeckWatcherTest, ReloadPublishesANewVersion) {
+    writeDeck({ "歴史", "友達" });
+    DeckWatcher watcher(Quiz::buildDeck(deckFile), { deckFile }, [this]() { return Quiz::buildDeck(deckFile); });
+    std::shared_ptr<const Deck> before = watcher.current();
+    ASSERT_NE(before, nullptr);
+    EXPECT_EQ(watcher.version(), 0u);
+
+    writeDeck({ "歴史" });
+    ASSERT_TRUE(watcher.reload());
+    EXPECT_EQ(watcher.version(), 1u);
+    EXPECT_EQ(watcher.current()->items.size(), 1u);
+    // Whoever held the old deck still has it.
+    EXPECT_EQ(before->items.size(), 2u);
+}
+
+TEST_F(DeckWatcherTest, BrokenFileKeepsTheCurrentDeck) {
+    writeDeck({ "歴史" });
+    DeckWatcher watcher(Quiz::buildDeck(deckFile), { deckFile }, [this]() { return Quiz::buildDeck(deckFile); });
+
+    std::ofstream(deckFile) << "[ {";
+    EXPECT_FALSE(watcher.reload());
+    EXPECT_EQ(watcher.version(), 0u);
+    EXPECT_EQ(watcher.current()->items.size(), 1u);
+}
+
+TEST_F(DeckWatcherTest, RebuildsWhenTheFileChanges) {
+    writeDeck({ "歴史" });
+    DeckWatcher watcher(Quiz::buildDeck(deckFile), { deckFile }, [this]() { return Quiz::buildDeck(deckFile); });
+    ASSERT_TRUE(watcher.start());
+
+    writeDeck({ "歴史", "友達", "料理" });
+    for (int i = 0; i < 50 && watcher.version() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_EQ(watcher.version(), 1u);
+    EXPECT_EQ(watcher.current()->items.size(), 3u);
+    watcher.stop();
+}
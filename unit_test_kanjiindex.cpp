@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+#include "quiz_logic/kanjiindex.h"
+#include <cstdio>
+#include <fstream>
+
+class KanjiIndexTest : public ::testing::Test {
+protected:
+    KanjiIndex index;
+    const std::string kradFile = "test_kradfile";
+
+    void SetUp() override {
+        std::ofstream file(kradFile);
+        file << "# test decomposition\n";
+        file << "歴 : 厂 止 木\n";
+        file << "暦 : 厂 日 木\n";
+        file << "史 : 口 乂\n";
+        file << "休 : 化 木\n";
+        file << "体 : 化 木 一\n";
+        file.close();
+        index.loadKradfile(kradFile);
+    }
+
+    void TearDown() override {
+        std::remove(kradFile.c_str());
+    }
+};
+
+TEST_F(KanjiIndexTest, LoadsComponents) {
+    EXPECT_EQ(index.kanjiCount(), 5u);
+    EXPECT_EQ(index.componentCount(), 8u);
+}
+
+TEST_F(KanjiIndexTest, JaccardSimilarity) {
+    EXPECT_DOUBLE_EQ(index.similarity("歴", "暦"), 0.5);
+    EXPECT_DOUBLE_EQ(index.similarity("歴", "史"), 0.0);
+    EXPECT_DOUBLE_EQ(index.similarity("歴", "歴"), 1.0);
+    EXPECT_DOUBLE_EQ(index.similarity("歴", "無"), 0.0);
+}
+
+TEST_F(KanjiIndexTest, TopKDrivesVariants) {
+    Vocab history;
+    history.setKanji("歴史");
+    index.buildSimilar({ history }, 2);
+
+    const std::string reki = "歴";
+    std::vector<uint32_t> similar = index.similar(utf8::peek_next(reki.begin(), reki.end()));
+    ASSERT_FALSE(similar.empty());
+    EXPECT_EQ(KanjiIndex::toUtf8(similar[0]), "暦");
+
+    std::vector<std::string> variants = index.confusableVariants("歴史", 3);
+    ASSERT_FALSE(variants.empty());
+    EXPECT_EQ(variants[0], "暦史");
+}
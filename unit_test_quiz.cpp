@@ -191,4 +191,48 @@ TEST_F(QuizTest, LoadQuiz) {
     // Additional assertions to verify the loaded quiz data
 }
 
+TEST_F(QuizTest, LookaheadListener) {
+    for (const char* kanji : { "一", "二", "三" }) {
+        Vocab vocab;
+        vocab.setKanji(kanji);
+        quiz.addVocab(vocab);
+    }
+
+    std::vector<Vocab> announced;
+    quiz.setUpcomingListener([&](const std::vector<Vocab>& upcoming) { announced = upcoming; }, 2);
+
+    EXPECT_LT(quiz.nextQuestionIndex({}, 3), 3u);
+    ASSERT_EQ(announced.size(), 2u);
+
+    // The window slides by one: the second announced item is now first.
+    size_t second = quiz.deck()->indexOf(announced[1]);
+    ASSERT_NE(second, Deck::NOT_FOUND);
+    quiz.nextQuestionIndex({}, 2);
+    ASSERT_EQ(announced.size(), 1u);
+    EXPECT_EQ(quiz.deck()->indexOf(announced[0]), second);
+
+    // Nothing is drawn beyond the last question.
+    quiz.nextQuestionIndex({}, 1);
+    EXPECT_TRUE(announced.empty());
+}
+
+TEST_F(QuizTest, ListeningAcceptsMeaningOrReading) {
+    Vocab vocab;
+    vocab.setKanji("友達");
+    vocab.setHiragana("ともだち");
+    vocab.setRomaji("tomodachi");
+    vocab.setEnglish({ "friend", "companion" });
+
+    std::istringstream input("8\n");
+    std::streambuf* original = std::cin.rdbuf(input.rdbuf());
+    quiz.selectTestType();
+    std::cin.rdbuf(original);
+
+    EXPECT_TRUE(quiz.checkAnswer(vocab, "ともだち"));
+    EXPECT_TRUE(quiz.checkAnswer(vocab, "Friend"));
+    EXPECT_TRUE(quiz.checkAnswer(vocab, "companion"));
+    EXPECT_FALSE(quiz.checkAnswer(vocab, "tomodachi"));
+    EXPECT_EQ(quiz.getCorrectAnswer(vocab), "ともだち");
+}
+
 // ... Add more tests for the remaining functions
@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+#include "quiz_logic/quizsession.h"
+
+class QuizSessionTest : public ::testing::Test {
+protected:
+    std::shared_ptr<Deck> deck = std::make_shared<Deck>();
+
+    void addItem(const std::string& kanji, const std::string& hiragana, const std::string& english,
+                 const std::string& partOfSpeech = "noun") {
+        Vocab vocab;
+        vocab.setKanji(kanji);
+        vocab.setHiragana(hiragana);
+        vocab.setEnglish({ english });
+        vocab.setPartOfSpeech(partOfSpeech);
+        deck->items.push_back(vocab);
+    }
+
+    void SetUp() override {
+        addItem("友達", "ともだち", "friend");
+        addItem("料理", "りょうり", "cooking");
+        addItem("食べる", "たべる", "to eat", "ru-verb");
+        deck->conjugations.build(deck->items);
+    }
+};
+
+TEST_F(QuizSessionTest, GradesAndCounts) {
+    QuizSession session(deck, "Kanji to Hiragana", 3, LearnerState(), 1);
+    ASSERT_TRUE(session.error().empty());
+
+    const SessionQuestion& first = session.nextQuestion();
+    ASSERT_NE(first.item, Deck::NOT_FOUND);
+    EXPECT_TRUE(session.pending());
+    EXPECT_EQ(session.submitAnswer(deck->items[first.item].getHiragana()).status, AnswerStatus::Correct);
+
+    session.nextQuestion();
+    EXPECT_EQ(session.submitAnswer("wrong").status, AnswerStatus::Incorrect);
+
+    // Neither a blank answer nor quitting closes the question.
+    session.nextQuestion();
+    AnswerResult blank = session.submitAnswer("   ");
+    EXPECT_EQ(blank.status, AnswerStatus::Invalid);
+    EXPECT_EQ(blank.message, "Please enter an answer.");
+    EXPECT_EQ(session.submitAnswer("quit").status, AnswerStatus::Quit);
+    EXPECT_TRUE(session.pending());
+    EXPECT_FALSE(session.finished());
+
+    EXPECT_EQ(session.submitAnswer("wrong").status, AnswerStatus::Incorrect);
+    EXPECT_TRUE(session.finished());
+    EXPECT_EQ(session.learner().totalQuestions, 3u);
+    EXPECT_EQ(session.learner().correctAnswers, 1);
+    EXPECT_EQ(session.nextQuestion().item, Deck::NOT_FOUND);
+}
+
+TEST_F(QuizSessionTest, OpenQuestionIsNotRedrawn) {
+    QuizSession session(deck, "Hiragana to English", 5, LearnerState(), 7);
+    size_t item = session.nextQuestion().item;
+    EXPECT_EQ(session.nextQuestion().item, item);
+    EXPECT_EQ(session.asked(), 1u);
+    EXPECT_EQ(session.submitAnswer("").status, AnswerStatus::Invalid);
+}
+
+TEST_F(QuizSessionTest, DrillAnswerIsFixedPerQuestion) {
+    QuizSession session(deck, "Conjugation", 4, LearnerState(), 3);
+    ASSERT_TRUE(session.error().empty());
+    for (int i = 0; i < 4; ++i) {
+        const SessionQuestion& question = session.nextQuestion();
+        EXPECT_EQ(question.item, 2u);  // the only verb
+        EXPECT_EQ(session.submitAnswer(session.expected()).status, AnswerStatus::Correct);
+    }
+    EXPECT_EQ(session.learner().correctAnswers, 4);
+}
+
+TEST_F(QuizSessionTest, ReportsWhyAModeCannotRun) {
+    EXPECT_EQ(QuizSession(deck, "Fill in the Blank").error(), "No example sentences available.");
+    EXPECT_EQ(QuizSession(deck, "Confusable Kanji").error(), "No kanji decomposition data available.");
+    EXPECT_EQ(QuizSession(deck, "Reading Aloud").error(), "Invalid test type.");
+    EXPECT_EQ(QuizSession(std::make_shared<Deck>(), "Kanji to Hiragana").error(), "No vocabularies loaded.");
+    EXPECT_FALSE(QuizSession(deck, "Kanji to Hiragana").finished());
+}
+
+TEST_F(QuizSessionTest, SessionsShareTheDeckNotTheState) {
+    std::shared_ptr<const Deck> shared = deck;
+    QuizSession alice(shared, "Kanji to Hiragana", 2, LearnerState(), 1);
+    QuizSession bob(shared, "Kanji to Hiragana", 2, LearnerState(), 2);
+    EXPECT_EQ(&alice.deck(), &bob.deck());
+
+    const SessionQuestion& question = alice.nextQuestion();
+    alice.submitAnswer(deck->items[question.item].getHiragana());
+    EXPECT_EQ(alice.learner().correctAnswers, 1);
+    EXPECT_EQ(bob.learner().totalQuestions, 0u);
+    EXPECT_FALSE(bob.pending());
+}
+
+TEST_F(QuizSessionTest, LearnerFollowsItemsToANewDeck) {
+    LearnerState learner;
+    LearnerState::TimePoint asked = LearnerState::TimePoint() + std::chrono::hours(1);
+    learner.setLastAsked(0, asked);                                     // 友達
+    learner.setLastAsked(2, asked + std::chrono::hours(1));             // 食べる
+
+    // 料理 is gone, 友達 moved, 先生 is new.
+    Deck edited;
+    edited.items = { deck->items[2], deck->items[0] };
+    Vocab added;
+    added.setKanji("先生");
+    added.setHiragana("せんせい");
+    edited.items.push_back(added);
+
+    learner.remap(*deck, edited);
+    ASSERT_EQ(learner.lastAsked.size(), 3u);
+    EXPECT_EQ(learner.lastAskedAt(0), asked + std::chrono::hours(1));
+    EXPECT_EQ(learner.lastAskedAt(1), asked);
+    EXPECT_EQ(learner.lastAskedAt(2), LearnerState::TimePoint());
+}
+
+TEST_F(QuizSessionTest, ListeningAcceptsMeaningOrReading) {
+    QuizSession session(deck, "Listening Comprehension", 1, LearnerState(), 5);
+    const SessionQuestion& question = session.nextQuestion();
+    EXPECT_TRUE(question.listening);
+    EXPECT_EQ(question.prompt.find(deck->items[question.item].getKanji()), std::string::npos);
+    EXPECT_EQ(session.submitAnswer(deck->items[question.item].getEnglish()[0]).status, AnswerStatus::Correct);
+}
+
+TEST_F(QuizSessionTest, LookaheadStopsAtTheLastQuestion) {
+    QuizSession session(deck, "Kanji to Hiragana", 3, LearnerState(), 9);
+    std::vector<Vocab> announced;
+    session.setUpcomingListener([&](const std::vector<Vocab>& upcoming) { announced = upcoming; }, 2);
+
+    std::vector<size_t> sizes;
+    while (!session.finished()) {
+        session.nextQuestion();
+        sizes.push_back(announced.size());
+        session.submitAnswer("x");
+    }
+    EXPECT_EQ(sizes, (std::vector<size_t>{ 2, 1, 0 }));
+}
+
+TEST_F(QuizSessionTest, AnswerHelpers) {
+    EXPECT_TRUE(QuizSession::answersMatch("Tomo-dachi", "tomodachi"));
+    EXPECT_FALSE(QuizSession::answersMatch("-tomodachi", "tomodachi"));
+    EXPECT_TRUE(QuizSession::containsInvalidCharacters("a]b"));
+    EXPECT_FALSE(QuizSession::containsInvalidCharacters("ともだち"));
+    EXPECT_EQ(QuizSession::answerError("te--st"), "Answer should not contain consecutive dashes (--). Please try again.");
+    EXPECT_EQ(QuizSession::answerError("test"), "");
+}
@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+#include "quiz_logic/sentenceindex.h"
+#include <cstdio>
+#include <fstream>
+
+class SentenceIndexTest : public ::testing::Test {
+protected:
+    std::vector<Vocab> vocabList;
+    const std::string corpusFile = "test_sentences.tsv";
+
+    void SetUp() override {
+        vocabList.push_back(Vocab({
+            {"kanji", "友達"}, {"hiragana", "ともだち"}, {"romaji", "tomodachi"},
+            {"english", std::vector<std::string>{"friend"}}, {"part_of_speech", "noun"},
+            {"dialogue", "1-2"}, {"lesson", "1"}, {"difficulty", 1.0}
+        }));
+        vocabList.push_back(Vocab({
+            {"kanji", "歴史"}, {"hiragana", "れきし"}, {"romaji", "rekishi"},
+            {"english", std::vector<std::string>{"history"}}, {"part_of_speech", "noun"},
+            {"dialogue", "1-2"}, {"lesson", "1"}, {"difficulty", 1.0}
+        }));
+        vocabList.push_back(Vocab({
+            {"kanji", "学生"}, {"hiragana", "がくせい"}, {"romaji", "gakusei"},
+            {"english", std::vector<std::string>{"student"}}, {"part_of_speech", "noun"},
+            {"dialogue", "1-2"}, {"lesson", "1"}, {"difficulty", 1.0}
+        }));
+
+        std::ofstream file(corpusFile);
+        file << "1\tjpn\t私の友達は学生です。\n";
+        file << "2\teng\tMy friend is a student.\n";
+        file << "3\t歴史が好きです。\t4\tI like history.\n";
+        file << "# comment line\n";
+        file << "ともだちと遊ぶ。\tI play with friends.\n";
+        file << "5\tjpn\t今日は晴れです。\n";
+    }
+
+    void TearDown() override {
+        std::remove(corpusFile.c_str());
+    }
+};
+
+TEST(AhoCorasickTest, FindsOverlappingPatterns) {
+    AhoCorasick automaton;
+    automaton.addPattern("he", 0);
+    automaton.addPattern("she", 1);
+    automaton.addPattern("hers", 2);
+    automaton.build();
+
+    std::vector<int> found;
+    automaton.scan("ushers", [&](int id, size_t, size_t) { found.push_back(id); });
+
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found, (std::vector<int>{0, 1, 2}));
+}
+
+TEST_F(SentenceIndexTest, BuildsPostingsInOnePass) {
+    SentenceIndex index;
+    EXPECT_EQ(index.build(vocabList, corpusFile), 3u);  // 晴れ sentence matches nothing
+
+    EXPECT_EQ(index.postingCount(vocabList[0]), 2u);
+    EXPECT_EQ(index.postingCount(vocabList[1]), 1u);
+    EXPECT_EQ(index.postingCount(vocabList[2]), 1u);
+    EXPECT_EQ(index.itemsWithSentences().size(), 3u);
+}
+
+TEST_F(SentenceIndexTest, BlanksTheMatchedSurfaceForm) {
+    SentenceIndex index;
+    index.build(vocabList, corpusFile);
+
+    const SentencePosting& posting = index.posting(vocabList[1], 0);
+    EXPECT_EQ(index.blankSentence(posting), "＿＿＿が好きです。");
+    EXPECT_EQ(index.sentence(posting).english, "I like history.");
+
+    const SentencePosting& kana = index.posting(vocabList[0], 1);
+    EXPECT_EQ(index.blankSentence(kana, "__"), "__と遊ぶ。");
+}
+
+TEST_F(SentenceIndexTest, JsonRoundTrip) {
+    SentenceIndex index;
+    index.build(vocabList, corpusFile);
+
+    SentenceIndex restored;
+    ASSERT_TRUE(restored.fromJson(index.toJson()));
+
+    EXPECT_EQ(restored.getDeckFingerprint(), SentenceIndex::deckFingerprint(vocabList));
+    EXPECT_EQ(restored.sentenceCount(), index.sentenceCount());
+    EXPECT_EQ(restored.postingCount(vocabList[0]), 2u);
+    EXPECT_EQ(restored.blankSentence(restored.posting(vocabList[2], 0)), "私の友達は＿＿＿です。");
+
+    // Files from before item_keys name the items instead.
+    nlohmann::json legacy = index.toJson();
+    legacy.erase("item_keys");
+    legacy["items"] = { "友達\tともだち", "歴史\tれきし", "学生\tがくせい" };
+    SentenceIndex old;
+    ASSERT_TRUE(old.fromJson(legacy));
+    EXPECT_EQ(old.postingCount(vocabList[0]), 2u);
+    EXPECT_EQ(old.postingCount(vocabList[1]), 1u);
+}
+
+TEST_F(SentenceIndexTest, JsonOutOfBoundsIsRejected) {
+    SentenceIndex index;
+    index.build(vocabList, corpusFile);
+    const nlohmann::json good = index.toJson();
+
+    nlohmann::json badSentence = good;
+    badSentence["postings"][0] = 99;
+    nlohmann::json badSpan = good;
+    badSpan["postings"][1] = 1000;
+    nlohmann::json badOffsets = good;
+    badOffsets["offsets"].back() = 1000;
+    nlohmann::json missingRow = good;
+    missingRow["offsets"].erase(missingRow["offsets"].size() - 1);
+    nlohmann::json decreasing = good;
+    decreasing["offsets"][1] = 5;
+    decreasing["offsets"][2] = 1;
+
+    for (const auto& bad : { badSentence, badSpan, badOffsets, missingRow, decreasing }) {
+        SentenceIndex restored;
+        EXPECT_FALSE(restored.fromJson(bad));
+        EXPECT_TRUE(restored.empty());
+        EXPECT_EQ(restored.postingCount(vocabList[0]), 0u);
+    }
+}
@@ -0,0 +1,608 @@
+#ifndef AUDIOENGINE_H
+#define AUDIOENGINE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include "audiopack.h"
+
+/**
+ * @brief Output format and buffer size of the audio device.
+ */
+struct AudioConfig {
+    int sampleRate = 44100;
+    Uint16 format = MIX_DEFAULT_FORMAT;
+    int channels = 2;
+    int bufferFrames = 2048;  /**< Frames per mixer callback; the main latency term. */
+
+    static const int SPEECH_SAMPLE_RATE = 24000;
+    static const int SPEECH_CHANNELS = 1;
+
+    /**
+     * @brief VOICEVOX's default output format (24 kHz mono) and a 256-frame
+     *        buffer (about 11 ms).
+     *
+     * This assumes the clips are in that format too: speech from an engine
+     * left at its default outputSamplingRate and outputStereo, and prompts
+     * recorded or packed the same way. Anything else still plays, converted
+     * when it is loaded. AudioEngine::open() reports a device that would not
+     * take the format and loadPack() reports clips that do not match it.
+     */
+    static AudioConfig lowLatency(int bufferFrames = 256) {
+        AudioConfig config;
+        config.sampleRate = SPEECH_SAMPLE_RATE;
+        config.channels = SPEECH_CHANNELS;
+        config.bufferFrames = bufferFrames;
+        return config;
+    }
+};
+
+/**
+ * @brief Play-to-output latency of sounds started with AudioEngine::play.
+ *
+ * Measured from the play() call to the mixer callback that first mixes the
+ * sound, plus the length of the buffer it was mixed into (the time SDL needs
+ * to hand that buffer to the device). Driver and hardware delay beyond SDL's
+ * buffer is not visible from here.
+ */
+struct AudioLatency {
+    size_t samples = 0;
+    double lastMs = 0.0;
+    double averageMs = 0.0;
+    double maxMs = 0.0;
+    double bufferMs = 0.0;  /**< Length of one mixer buffer as opened. */
+};
+
+/**
+ * @brief The process-wide audio device and a bank of preloaded sounds.
+ *
+ * SDL audio and the mixer are opened once, on first use, and closed at exit;
+ * players and sounds never reopen the device. Sounds are decoded into
+ * Mix_Chunk when they are loaded and addressed by a small integer id, so
+ * playing one is a single Mix_PlayChannel on a free mixer channel and
+ * several clips can overlap.
+ *
+ *     AudioEngine& engine = AudioEngine::instance();
+ *     AudioEngine::SoundId no = engine.load("no", "wav/no.wav");
+ *     engine.play(no);
+ *
+ * Call configure() before anything opens the device to pick the output
+ * format, e.g. AudioConfig::lowLatency() for prompt feedback.
+ *
+ * Completion is reported through Mix_ChannelFinished and
+ * Mix_HookMusicFinished: pass a callback to play(), or wait on the future
+ * from playAsync(), instead of sleeping for a guessed clip length.
+ *
+ * enqueue() lines clips up on the music stream through Mix_HookMusic: the
+ * mixer callback copies one clip's samples straight after the previous
+ * one's, so a sequence such as prompt, answer, feedback tone plays without a
+ * gap and without the caller waiting on any of it. The queue and
+ * AudioPlayer share the music stream; starting an AudioPlayer stops the queue.
+ *
+ * The queue is a preallocated ring of QUEUE_CAPACITY slots, so the mixer
+ * callback neither locks nor allocates: enqueue() fills a slot and publishes
+ * it, the callback plays it and hands it on, and a finisher thread runs its
+ * callback and frees its samples before the slot is reused.
+ */
+class AudioEngine {
+public:
+    typedef int SoundId;
+    /**
+     * For play() and music, runs on SDL's audio thread (or in the thread that
+     * halted the sound) with the device locked; it must not call SDL_mixer and
+     * should return quickly. For enqueue(), runs on the finisher thread.
+     */
+    typedef std::function<void()> FinishedCallback;
+
+    static const SoundId INVALID_SOUND = -1;
+    static const int MIX_CHANNELS = 16;
+    static const size_t QUEUE_CAPACITY = 64;  /**< Clips queued or playing at once. */
+
+    static AudioEngine& instance();
+
+    /**
+     * @brief Sets the format the device will be opened with.
+     * @return False if the device is already open; sounds in the bank are
+     *         converted to the open format, so it cannot change afterwards.
+     */
+    bool configure(const AudioConfig& config);
+    const AudioConfig& config() const { return config_; }
+
+    /** @brief Opens the device if it is not open yet. @return True if it is open. */
+    bool open();
+    bool isOpen() const { return open_; }
+
+    /** @return Play-to-output latency measured so far. */
+    AudioLatency latency() const;
+
+    /**
+     * @brief Decodes a WAV file into the bank. Loading a name twice returns the first id.
+     * @return The sound id, or INVALID_SOUND.
+     */
+    SoundId load(const std::string& name, const std::string& filePath);
+
+    /** @brief Decodes an in-memory WAV (e.g. a synthesis result); the bytes are not kept. */
+    SoundId load(const std::string& name, const uint8_t* data, size_t bytes);
+
+    /**
+     * @brief Decodes every clip of a pack under its clip name, converting it to
+     *        the device format. Clips recorded in another format are counted
+     *        and reported, since converting them costs time at load.
+     * @return The number loaded.
+     */
+    size_t loadPack(const AudioPack& pack);
+
+    /** @return The id of a loaded sound, or INVALID_SOUND. */
+    SoundId find(const std::string& name) const;
+
+    /**
+     * @param onFinished Runs once when the sound ends or is halted.
+     * @return The channel the sound plays on, or -1 if it could not start
+     *         (onFinished is not called then).
+     */
+    int play(SoundId id, int loops = 0, FinishedCallback onFinished = nullptr);
+
+    /** @return Becomes ready when the sound ends; ready at once if it could not start. */
+    std::future<void> playAsync(SoundId id, int loops = 0);
+
+    /**
+     * @brief Sets what runs when the current music (AudioPlayer) ends or is halted.
+     *        Music is a single stream, so there is one slot; setting it replaces
+     *        the previous callback without running it.
+     */
+    void setMusicFinished(FinishedCallback onFinished);
+
+    /** @brief Halts one channel, or every channel with -1. */
+    void stop(int channel = -1);
+
+    /**
+     * @brief Appends a bank sound to the gapless queue. The sound must stay in
+     *        the bank until it has played.
+     * @param onFinished Runs on the engine's finisher thread once the last
+     *        sample is mixed, or when the queue is stopped before that. It must
+     *        not enqueue or stop the queue.
+     * @return False if the id is unknown, the device cannot be opened or
+     *         QUEUE_CAPACITY clips are already waiting.
+     */
+    bool enqueue(SoundId id, FinishedCallback onFinished = nullptr);
+
+    /** @brief Appends an in-memory WAV (e.g. a synthesis result); it is decoded now. */
+    bool enqueue(const uint8_t* wav, size_t bytes, FinishedCallback onFinished = nullptr);
+
+    /**
+     * @brief Drops every queued clip and hands the music stream back. Returns
+     *        once the callbacks of the dropped clips have run.
+     */
+    void stopQueue();
+
+    /** @return Clips queued or playing. */
+    size_t queued() const;
+
+    /** @brief Frees every sound in the bank. Ids handed out earlier become invalid. */
+    void clear();
+
+    size_t size() const { return bank_.size(); }
+
+    AudioEngine(const AudioEngine&) = delete;
+    AudioEngine& operator=(const AudioEngine&) = delete;
+
+private:
+    AudioEngine() = default;
+    ~AudioEngine();
+
+    SoundId add(const std::string& name, Mix_Chunk* chunk);
+    static void postMix(void* engine, Uint8* stream, int bytes);
+    static void channelFinished(int channel);
+    static void musicFinished();
+    static void mixQueue(void* engine, Uint8* stream, int bytes);
+
+    struct QueuedClip {
+        const Uint8* data = nullptr;
+        size_t bytes = 0;
+        std::shared_ptr<std::vector<Uint8>> owned;  /**< Samples of clips not in the bank. */
+        FinishedCallback onFinished;
+    };
+
+    bool enqueue(QueuedClip clip);
+    void runFinisher();
+    void stopFinisher();
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    AudioConfig config_;
+    bool open_ = false;
+    int bytesPerFrame_ = 4;
+    std::atomic<int64_t> playRequestedNs_{ 0 };  /**< 0: nothing waiting to be measured. */
+    std::atomic<uint64_t> latencySamples_{ 0 };
+    std::atomic<int64_t> latencyLastNs_{ 0 };
+    std::atomic<int64_t> latencyTotalNs_{ 0 };
+    std::atomic<int64_t> latencyMaxNs_{ 0 };
+    std::atomic<int64_t> bufferNs_{ 0 };
+    std::mutex finishedMutex_;  /**< Guards the callbacks below; never held while calling SDL. */
+    std::vector<FinishedCallback> channelCallbacks_;  /**< Indexed by mixer channel. */
+    FinishedCallback musicCallback_;
+
+    // Ring slot n % QUEUE_CAPACITY moves through three stages, each index
+    // written by one thread only: enqueue() fills slots up to queueTail_, the
+    // mixer callback plays them up to queueMixed_, and the finisher runs their
+    // callbacks and clears them up to queueReaped_, after which they are free.
+    std::vector<QueuedClip> ring_ = std::vector<QueuedClip>(QUEUE_CAPACITY);
+    std::atomic<uint64_t> queueTail_{ 0 };
+    std::atomic<uint64_t> queueMixed_{ 0 };
+    std::atomic<uint64_t> queueReaped_{ 0 };
+    size_t mixPosition_ = 0;         /**< Bytes played of the clip at queueMixed_; mixer callback only. */
+    bool queueHooked_ = false;       /**< Main thread only. */
+    SDL_sem* mixedSignal_ = nullptr; /**< Posted by the mixer callback when clips finish. */
+    std::atomic<bool> finisherStopping_{ false };
+    std::thread finisher_;
+    std::mutex reapedMutex_;         /**< Pairs with reapedChanged_ for stopQueue(); never taken by the mixer. */
+    std::condition_variable reapedChanged_;
+    std::vector<Mix_Chunk*> bank_;                  /**< Indexed by SoundId. */
+    std::unordered_map<std::string, SoundId> names_;
+};
+
+inline AudioEngine& AudioEngine::instance() {
+    static AudioEngine engine;
+    return engine;
+}
+
+inline AudioEngine::~AudioEngine() {
+    clear();
+    stopFinisher();
+    if (open_) {
+        Mix_HookMusicFinished(nullptr);
+        Mix_ChannelFinished(nullptr);
+        Mix_CloseAudio();
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    }
+}
+
+inline bool AudioEngine::open() {
+    if (open_) return true;
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        std::cerr << "Failed to initialize SDL audio: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    if (Mix_OpenAudio(config_.sampleRate, config_.format, config_.channels, config_.bufferFrames) < 0) {
+        std::cerr << "Failed to open audio: " << Mix_GetError() << std::endl;
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    // SDL may substitute a format the device supports; keep what was obtained.
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    if (Mix_QuerySpec(&frequency, &format, &channels)) {
+        if (frequency != config_.sampleRate || channels != config_.channels) {
+            std::cerr << "Audio device opened at " << frequency << " Hz, " << channels << " channel(s) instead of "
+                      << config_.sampleRate << " Hz, " << config_.channels << "; clips will be resampled." << std::endl;
+        }
+        config_.sampleRate = frequency;
+        config_.format = format;
+        config_.channels = channels;
+    }
+    bytesPerFrame_ = (config_.format & 0xFF) / 8 * config_.channels;
+
+    Mix_AllocateChannels(MIX_CHANNELS);
+    channelCallbacks_.assign(MIX_CHANNELS, nullptr);
+    Mix_SetPostMix(&AudioEngine::postMix, this);
+    Mix_ChannelFinished(&AudioEngine::channelFinished);
+    Mix_HookMusicFinished(&AudioEngine::musicFinished);
+    open_ = true;
+    return true;
+}
+
+inline bool AudioEngine::configure(const AudioConfig& config) {
+    if (open_) return false;
+    config_ = config;
+    return true;
+}
+
+// Runs on SDL's audio thread once per buffer, after the channels are mixed.
+inline void AudioEngine::postMix(void* engine, Uint8*, int bytes) {
+    AudioEngine* self = static_cast<AudioEngine*>(engine);
+    int64_t bufferNs = static_cast<int64_t>(bytes / self->bytesPerFrame_) * 1000000000LL / self->config_.sampleRate;
+    self->bufferNs_.store(bufferNs, std::memory_order_relaxed);
+
+    int64_t requested = self->playRequestedNs_.exchange(0, std::memory_order_relaxed);
+    if (requested == 0) return;
+
+    int64_t latency = now() - requested + bufferNs;
+    self->latencyLastNs_.store(latency, std::memory_order_relaxed);
+    self->latencyTotalNs_.fetch_add(latency, std::memory_order_relaxed);
+    int64_t max = self->latencyMaxNs_.load(std::memory_order_relaxed);
+    while (latency > max && !self->latencyMaxNs_.compare_exchange_weak(max, latency, std::memory_order_relaxed)) {
+    }
+    self->latencySamples_.fetch_add(1, std::memory_order_release);
+}
+
+inline void AudioEngine::channelFinished(int channel) {
+    AudioEngine& self = instance();
+    FinishedCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(self.finishedMutex_);
+        if (channel < 0 || static_cast<size_t>(channel) >= self.channelCallbacks_.size()) return;
+        callback.swap(self.channelCallbacks_[channel]);
+    }
+    if (callback) callback();
+}
+
+inline void AudioEngine::musicFinished() {
+    AudioEngine& self = instance();
+    FinishedCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(self.finishedMutex_);
+        callback.swap(self.musicCallback_);
+    }
+    if (callback) callback();
+}
+
+inline void AudioEngine::setMusicFinished(FinishedCallback onFinished) {
+    std::lock_guard<std::mutex> lock(finishedMutex_);
+    musicCallback_ = std::move(onFinished);
+}
+
+inline AudioLatency AudioEngine::latency() const {
+    AudioLatency result;
+    result.samples = static_cast<size_t>(latencySamples_.load(std::memory_order_acquire));
+    result.lastMs = latencyLastNs_.load(std::memory_order_relaxed) / 1e6;
+    result.maxMs = latencyMaxNs_.load(std::memory_order_relaxed) / 1e6;
+    result.bufferMs = bufferNs_.load(std::memory_order_relaxed) / 1e6;
+    if (result.samples > 0) result.averageMs = latencyTotalNs_.load(std::memory_order_relaxed) / 1e6 / result.samples;
+    return result;
+}
+
+inline AudioEngine::SoundId AudioEngine::add(const std::string& name, Mix_Chunk* chunk) {
+    SoundId id = static_cast<SoundId>(bank_.size());
+    bank_.push_back(chunk);
+    names_[name] = id;
+    return id;
+}
+
+inline AudioEngine::SoundId AudioEngine::load(const std::string& name, const std::string& filePath) {
+    SoundId existing = find(name);
+    if (existing != INVALID_SOUND) return existing;
+    if (!open()) return INVALID_SOUND;
+
+    // Chunks are converted to the device format here, so the device must be open.
+    Mix_Chunk* chunk = Mix_LoadWAV(filePath.c_str());
+    if (!chunk) {
+        std::cerr << "Failed to load sound " << filePath << ": " << Mix_GetError() << std::endl;
+        return INVALID_SOUND;
+    }
+    return add(name, chunk);
+}
+
+inline AudioEngine::SoundId AudioEngine::load(const std::string& name, const uint8_t* data, size_t bytes) {
+    SoundId existing = find(name);
+    if (existing != INVALID_SOUND) return existing;
+    if (!open()) return INVALID_SOUND;
+
+    SDL_RWops* rw = SDL_RWFromConstMem(data, static_cast<int>(bytes));
+    Mix_Chunk* chunk = rw ? Mix_LoadWAV_RW(rw, 1) : nullptr;
+    if (!chunk) {
+        std::cerr << "Failed to load sound " << name << ": " << Mix_GetError() << std::endl;
+        return INVALID_SOUND;
+    }
+    return add(name, chunk);
+}
+
+inline size_t AudioEngine::loadPack(const AudioPack& pack) {
+    size_t loaded = 0;
+    size_t converted = 0;
+    for (size_t i = 0; i < pack.size(); ++i) {
+        const AudioPackEntry& entry = pack.entry(i);
+        if (load(entry.name, pack.data(entry), static_cast<size_t>(entry.length)) == INVALID_SOUND) continue;
+        ++loaded;
+        if (static_cast<int>(entry.sampleRate) != config_.sampleRate || entry.channels != config_.channels) ++converted;
+    }
+    if (converted > 0) {
+        std::cerr << converted << " of " << loaded << " packed clips are not " << config_.sampleRate << " Hz, "
+                  << config_.channels << " channel(s); they were converted on load." << std::endl;
+    }
+    return loaded;
+}
+
+inline AudioEngine::SoundId AudioEngine::find(const std::string& name) const {
+    auto it = names_.find(name);
+    return it == names_.end() ? INVALID_SOUND : it->second;
+}
+
+inline int AudioEngine::play(SoundId id, int loops, FinishedCallback onFinished) {
+    if (id < 0 || static_cast<size_t>(id) >= bank_.size() || !bank_[id]) return -1;
+
+    // Pick the channel first so the callback is in place before the clip can end;
+    // a short clip may finish before Mix_PlayChannel even returns.
+    int channel = Mix_GroupAvailable(-1);
+    if (channel < 0) {
+        std::cerr << "Failed to play sound: all " << MIX_CHANNELS << " channels are busy" << std::endl;
+        return -1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex_);
+        channelCallbacks_[channel] = std::move(onFinished);
+    }
+
+    int64_t requested = now();
+    if (Mix_PlayChannel(channel, bank_[id], loops) < 0) {
+        std::cerr << "Failed to play sound: " << Mix_GetError() << std::endl;
+        std::lock_guard<std::mutex> lock(finishedMutex_);
+        channelCallbacks_[channel] = nullptr;
+        return -1;
+    }
+    // Only the first play per buffer is timed; others in the same buffer would read the same.
+    int64_t none = 0;
+    playRequestedNs_.compare_exchange_strong(none, requested, std::memory_order_relaxed);
+    return channel;
+}
+
+inline std::future<void> AudioEngine::playAsync(SoundId id, int loops) {
+    // std::function must be copyable, hence the shared promise.
+    std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+    std::future<void> future = done->get_future();
+    if (play(id, loops, [done]() { done->set_value(); }) < 0) {
+        done->set_value();
+    }
+    return future;
+}
+
+inline void AudioEngine::stop(int channel) {
+    if (open_) Mix_HaltChannel(channel);
+}
+
+inline bool AudioEngine::enqueue(SoundId id, FinishedCallback onFinished) {
+    if (id < 0 || static_cast<size_t>(id) >= bank_.size() || !bank_[id]) return false;
+    QueuedClip clip;
+    clip.data = bank_[id]->abuf;
+    clip.bytes = bank_[id]->alen;
+    clip.onFinished = std::move(onFinished);
+    return enqueue(std::move(clip));
+}
+
+inline bool AudioEngine::enqueue(const uint8_t* wav, size_t bytes, FinishedCallback onFinished) {
+    if (!open()) return false;
+    // Decoding converts to the device format; keep the samples and free the chunk.
+    SDL_RWops* rw = SDL_RWFromConstMem(wav, static_cast<int>(bytes));
+    Mix_Chunk* chunk = rw ? Mix_LoadWAV_RW(rw, 1) : nullptr;
+    if (!chunk) {
+        std::cerr << "Failed to decode queued audio: " << Mix_GetError() << std::endl;
+        return false;
+    }
+    QueuedClip clip;
+    clip.owned = std::make_shared<std::vector<Uint8>>(chunk->abuf, chunk->abuf + chunk->alen);
+    Mix_FreeChunk(chunk);
+    clip.data = clip.owned->data();
+    clip.bytes = clip.owned->size();
+    clip.onFinished = std::move(onFinished);
+    return enqueue(std::move(clip));
+}
+
+inline bool AudioEngine::enqueue(QueuedClip clip) {
+    if (!open()) return false;
+    if (!finisher_.joinable()) {
+        mixedSignal_ = SDL_CreateSemaphore(0);
+        if (!mixedSignal_) {
+            std::cerr << "Failed to start the clip queue: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        finisher_ = std::thread(&AudioEngine::runFinisher, this);
+    }
+
+    uint64_t tail = queueTail_.load(std::memory_order_relaxed);
+    if (tail - queueReaped_.load(std::memory_order_acquire) >= QUEUE_CAPACITY) {
+        std::cerr << "Failed to queue audio: " << QUEUE_CAPACITY << " clips are already queued" << std::endl;
+        return false;
+    }
+    ring_[tail % QUEUE_CAPACITY] = std::move(clip);
+    queueTail_.store(tail + 1, std::memory_order_release);
+
+    if (!queueHooked_) {
+        // The hook replaces music playback; let current music report its end first.
+        if (Mix_PlayingMusic()) Mix_HaltMusic();
+        Mix_HookMusic(&AudioEngine::mixQueue, this);
+        queueHooked_ = true;
+    }
+    return true;
+}
+
+// Runs on SDL's audio thread for every buffer while the queue is hooked. It
+// only copies samples and moves indices; finished clips go to the finisher.
+inline void AudioEngine::mixQueue(void* engine, Uint8* stream, int bytes) {
+    AudioEngine* self = static_cast<AudioEngine*>(engine);
+    uint64_t mixed = self->queueMixed_.load(std::memory_order_relaxed);
+    uint64_t tail = self->queueTail_.load(std::memory_order_acquire);
+    uint64_t first = mixed;
+    size_t filled = 0;
+    while (filled < static_cast<size_t>(bytes) && mixed != tail) {
+        const QueuedClip& clip = self->ring_[mixed % QUEUE_CAPACITY];
+        size_t count = std::min(clip.bytes - self->mixPosition_, static_cast<size_t>(bytes) - filled);
+        std::memcpy(stream + filled, clip.data + self->mixPosition_, count);
+        self->mixPosition_ += count;
+        filled += count;
+        if (self->mixPosition_ == clip.bytes) {
+            self->mixPosition_ = 0;
+            ++mixed;
+        }
+    }
+    std::memset(stream + filled, self->config_.format == AUDIO_U8 ? 0x80 : 0, static_cast<size_t>(bytes) - filled);
+    if (mixed != first) {
+        self->queueMixed_.store(mixed, std::memory_order_release);
+        SDL_SemPost(self->mixedSignal_);
+    }
+}
+
+// Runs the callbacks of finished clips and frees their samples, off the audio thread.
+inline void AudioEngine::runFinisher() {
+    while (true) {
+        SDL_SemWait(mixedSignal_);
+        uint64_t mixed = queueMixed_.load(std::memory_order_acquire);
+        uint64_t reaped = queueReaped_.load(std::memory_order_relaxed);
+        for (; reaped != mixed; ++reaped) {
+            QueuedClip clip = std::move(ring_[reaped % QUEUE_CAPACITY]);
+            ring_[reaped % QUEUE_CAPACITY] = QueuedClip();
+            if (clip.onFinished) clip.onFinished();
+        }
+        {
+            std::lock_guard<std::mutex> lock(reapedMutex_);
+            queueReaped_.store(reaped, std::memory_order_release);
+        }
+        reapedChanged_.notify_all();
+        if (finisherStopping_.load(std::memory_order_acquire)) return;
+    }
+}
+
+inline void AudioEngine::stopFinisher() {
+    if (!finisher_.joinable()) return;
+    finisherStopping_.store(true, std::memory_order_release);
+    SDL_SemPost(mixedSignal_);
+    finisher_.join();
+    SDL_DestroySemaphore(mixedSignal_);
+    mixedSignal_ = nullptr;
+}
+
+inline void AudioEngine::stopQueue() {
+    if (queueHooked_) {
+        Mix_HookMusic(nullptr, nullptr);  // waits out a running callback
+        queueHooked_ = false;
+    }
+    if (!finisher_.joinable()) return;
+    // The mixer is unhooked, so this thread can mark the rest as played.
+    uint64_t tail = queueTail_.load(std::memory_order_relaxed);
+    mixPosition_ = 0;
+    queueMixed_.store(tail, std::memory_order_release);
+    SDL_SemPost(mixedSignal_);
+    std::unique_lock<std::mutex> lock(reapedMutex_);
+    reapedChanged_.wait(lock, [this, tail]() { return queueReaped_.load(std::memory_order_acquire) == tail; });
+}
+
+inline size_t AudioEngine::queued() const {
+    return static_cast<size_t>(queueTail_.load(std::memory_order_acquire) - queueMixed_.load(std::memory_order_acquire));
+}
+
+inline void AudioEngine::clear() {
+    stopQueue();  // queued bank sounds point into chunks freed below
+    if (open_) Mix_HaltChannel(-1);  // a playing chunk must not be freed
+    for (Mix_Chunk* chunk : bank_) {
+        Mix_FreeChunk(chunk);
+    }
+    bank_.clear();
+    names_.clear();
+}
+
+#endif  // AUDIOENGINE_H
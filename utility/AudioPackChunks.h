@@ -0,0 +1,78 @@
+#ifndef AUDIOPACKCHUNKS_H
+#define AUDIOPACKCHUNKS_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include "audiopack.h"
+
+/**
+ * @brief Hands SDL_mixer chunks decoded straight from a mapped AudioPack.
+ *
+ * Each clip is decoded once, on first use, from the pack's memory via
+ * SDL_RWFromConstMem; no file is opened after the pack itself. The pack must
+ * stay open and the audio device must stay open while chunks are in use.
+ */
+class AudioPackChunks {
+public:
+    explicit AudioPackChunks(const AudioPack& pack) : pack_(pack) {}
+    ~AudioPackChunks();
+
+    AudioPackChunks(const AudioPackChunks&) = delete;
+    AudioPackChunks& operator=(const AudioPackChunks&) = delete;
+
+    /**
+     * @brief The decoded clip, e.g. get("hello").
+     * @return nullptr if the pack has no such clip or SDL_mixer cannot decode it.
+     */
+    Mix_Chunk* get(const std::string& name);
+
+    /**
+     * @brief Decodes every clip now, so the first play of each is instant.
+     * @return The number of clips decoded.
+     */
+    size_t preload();
+
+private:
+    Mix_Chunk* decode(const AudioPackEntry& entry);
+
+    const AudioPack& pack_;
+    std::unordered_map<std::string, Mix_Chunk*> chunks_;
+};
+
+inline AudioPackChunks::~AudioPackChunks() {
+    for (auto& chunk : chunks_) {
+        Mix_FreeChunk(chunk.second);
+    }
+}
+
+inline Mix_Chunk* AudioPackChunks::decode(const AudioPackEntry& entry) {
+    auto it = chunks_.find(entry.name);
+    if (it != chunks_.end()) return it->second;
+
+    SDL_RWops* rw = SDL_RWFromConstMem(pack_.data(entry), static_cast<int>(entry.length));
+    Mix_Chunk* chunk = rw ? Mix_LoadWAV_RW(rw, 1) : nullptr;
+    if (!chunk) {
+        std::cerr << "Failed to decode packed clip " << entry.name << ": " << Mix_GetError() << std::endl;
+        return nullptr;
+    }
+    chunks_[entry.name] = chunk;
+    return chunk;
+}
+
+inline Mix_Chunk* AudioPackChunks::get(const std::string& name) {
+    const AudioPackEntry* entry = pack_.find(name);
+    return entry ? decode(*entry) : nullptr;
+}
+
+inline size_t AudioPackChunks::preload() {
+    size_t decoded = 0;
+    for (size_t i = 0; i < pack_.size(); ++i) {
+        if (decode(pack_.entry(i))) ++decoded;
+    }
+    return decoded;
+}
+
+#endif  // AUDIOPACKCHUNKS_H
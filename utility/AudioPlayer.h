@@ -4,21 +4,27 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_mixer.h>
 #include <iostream>
+#include <vector>
+#include <cstdint>
+#include <future>
+#include "AudioEngine.h"
 
 /**
  * @brief The AudioPlayer class handles audio playback using SDL2 and SDL2_mixer.
+ *        It streams one piece of music; the device itself belongs to AudioEngine,
+ *        so any number of players can exist at once.
  * @see   https://www.libsdl.org/
  */
 class AudioPlayer {
 public:
     /**
-     * @brief Constructs an AudioPlayer object and initializes SDL audio subsystem.
-     *        Opens the audio device for playback.
+     * @brief Constructs an AudioPlayer object. Opens the audio device through
+     *        AudioEngine if nothing has opened it yet.
      */
     AudioPlayer();
 
     /**
-     * @brief Destructs the AudioPlayer object and closes the audio device.
+     * @brief Destructs the AudioPlayer object and frees its music. The device stays open.
      */
     ~AudioPlayer();
 
@@ -55,7 +61,25 @@ public:
      */
     bool loadAudio(const std::string& filePath);
 
-    void play();
+    /**
+     * @brief Loads audio straight from memory, e.g. a synthesis response.
+     *        The bytes are copied, so the caller's buffer may be released afterwards.
+     * @param audio The encoded audio (WAV, OGG, ...).
+     * @return True if the audio is successfully loaded, false otherwise.
+     */
+    bool loadAudio(const std::vector<uint8_t>& audio);
+
+    /**
+     * @brief Starts the loaded audio; music already playing and the clip queue are stopped first.
+     * @param onFinished Runs when playback ends or is stopped (see AudioEngine::FinishedCallback).
+     * @return False if nothing is loaded or playback could not start; onFinished is not called then.
+     */
+    bool play(AudioEngine::FinishedCallback onFinished = nullptr);
+
+    /** @return Becomes ready when playback ends or is stopped; ready at once if it cannot start. */
+    std::future<void> playAsync();
+
+    /** @brief Stop, pause and resume act only while this player's music holds the stream. */
     void stop();
     void pause();
     void resume();
@@ -63,41 +87,43 @@ public:
 private:
     Mix_Music* music_ = nullptr; /**< Pointer to the loaded audio data. */
     std::string filePath_;       /**< Path of the loaded audio file. */
+    std::vector<uint8_t> buffer_; /**< Backing bytes of in-memory audio; SDL_mixer streams from them. */
+
+    /** The player whose music was started last; the mixer streams one piece of music at a time. */
+    static AudioPlayer* owner_;
+
+    bool ownsMusic() const { return owner_ == this && Mix_PlayingMusic(); }
+    void release();
 };
 
+AudioPlayer* AudioPlayer::owner_ = nullptr;
+
 AudioPlayer::AudioPlayer() {
-    if (SDL_Init(SDL_INIT_AUDIO) < 0) {
-        std::cerr << "Failed to initialize SDL audio: " << SDL_GetError() << std::endl;
-    } else {
-        if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-            std::cerr << "Failed to open audio: " << Mix_GetError() << std::endl;
-        }
-    }
+    AudioEngine::instance().open();
 }
 
 AudioPlayer::~AudioPlayer() {
-    Mix_CloseAudio();
-    SDL_Quit();
+    release();
 }
 
 AudioPlayer::AudioPlayer(const AudioPlayer& other) {
     if (other.music_) {
-        filePath_ = other.filePath_;
-        music_ = Mix_LoadMUS(filePath_.c_str());
-        if (!music_) {
-            std::cerr << "Failed to load audio: " << Mix_GetError() << std::endl;
+        if (!other.buffer_.empty()) {
+            loadAudio(other.buffer_);
+        } else {
+            loadAudio(other.filePath_);
         }
     }
 }
 
 AudioPlayer& AudioPlayer::operator=(const AudioPlayer& other) {
     if (this != &other) {
-        Mix_FreeMusic(music_);
+        release();
         if (other.music_) {
-            filePath_ = other.filePath_;
-            music_ = Mix_LoadMUS(filePath_.c_str());
-            if (!music_) {
-                std::cerr << "Failed to load audio: " << Mix_GetError() << std::endl;
+            if (!other.buffer_.empty()) {
+                loadAudio(other.buffer_);
+            } else {
+                loadAudio(other.filePath_);
             }
         }
     }
@@ -105,46 +131,110 @@ AudioPlayer& AudioPlayer::operator=(const AudioPlayer& other) {
 }
 
 AudioPlayer::AudioPlayer(AudioPlayer&& other) noexcept
-    : music_(other.music_) {
+    : music_(other.music_),
+      filePath_(std::move(other.filePath_)),
+      buffer_(std::move(other.buffer_)) {  // moving keeps the heap block SDL reads from
     other.music_ = nullptr;
+    if (owner_ == &other) owner_ = this;
 }
 
 AudioPlayer& AudioPlayer::operator=(AudioPlayer&& other) noexcept {
     if (this != &other) {
-        Mix_FreeMusic(music_);
+        release();
         music_ = other.music_;
+        filePath_ = std::move(other.filePath_);
+        buffer_ = std::move(other.buffer_);
         other.music_ = nullptr;
+        if (owner_ == &other) owner_ = this;
     }
     return *this;
 }
 
+void AudioPlayer::release() {
+    if (music_) {
+        // Halting runs the finished callback; freeing playing music would skip it.
+        // Music another player started since is left alone.
+        if (ownsMusic()) Mix_HaltMusic();
+        if (owner_ == this) owner_ = nullptr;
+        Mix_FreeMusic(music_);
+        music_ = nullptr;
+    }
+    filePath_.clear();
+    buffer_.clear();
+}
+
 bool AudioPlayer::loadAudio(const std::string& filePath) {
+    release();
     music_ = Mix_LoadMUS(filePath.c_str());
     if (!music_) {
         std::cerr << "Failed to load audio: " << Mix_GetError() << std::endl;
         return false;
     }
+    filePath_ = filePath;
     return true;
 }
 
-void AudioPlayer::play() {
-    if (music_) {
-        if (Mix_PlayMusic(music_, 1) < 0) {
-            std::cerr << "Failed to play audio: " << Mix_GetError() << std::endl;
-        }
+bool AudioPlayer::loadAudio(const std::vector<uint8_t>& audio) {
+    release();
+    if (audio.empty()) {
+        std::cerr << "Failed to load audio: empty buffer" << std::endl;
+        return false;
+    }
+
+    buffer_ = audio;
+    SDL_RWops* rw = SDL_RWFromConstMem(buffer_.data(), static_cast<int>(buffer_.size()));
+    if (!rw) {
+        std::cerr << "Failed to load audio: " << SDL_GetError() << std::endl;
+        buffer_.clear();
+        return false;
+    }
+
+    // freesrc = 1: the RWops is closed together with the music.
+    music_ = Mix_LoadMUS_RW(rw, 1);
+    if (!music_) {
+        std::cerr << "Failed to load audio: " << Mix_GetError() << std::endl;
+        buffer_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool AudioPlayer::play(AudioEngine::FinishedCallback onFinished) {
+    if (!music_) return false;
+    // Take the music stream back from the clip queue, if it had it.
+    AudioEngine::instance().stopQueue();
+    // Let the previous music report its end before its callback is replaced.
+    if (Mix_PlayingMusic()) Mix_HaltMusic();
+
+    AudioEngine::instance().setMusicFinished(std::move(onFinished));
+    if (Mix_PlayMusic(music_, 1) < 0) {
+        std::cerr << "Failed to play audio: " << Mix_GetError() << std::endl;
+        AudioEngine::instance().setMusicFinished(nullptr);
+        return false;
+    }
+    owner_ = this;
+    return true;
+}
+
+std::future<void> AudioPlayer::playAsync() {
+    std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+    std::future<void> future = done->get_future();
+    if (!play([done]() { done->set_value(); })) {
+        done->set_value();
     }
+    return future;
 }
 
 void AudioPlayer::stop() {
-    Mix_HaltMusic();
+    if (ownsMusic()) Mix_HaltMusic();
 }
 
 void AudioPlayer::pause() {
-    Mix_PauseMusic();
+    if (ownsMusic()) Mix_PauseMusic();
 }
 
 void AudioPlayer::resume() {
-    Mix_ResumeMusic();
+    if (ownsMusic()) Mix_ResumeMusic();
 }
 
 #endif  // AUDIOPLAYER_H
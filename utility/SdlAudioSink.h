@@ -0,0 +1,60 @@
+#ifndef SDLAUDIOSINK_H
+#define SDLAUDIOSINK_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <cstdlib>
+#include "AudioPlayer.h"
+#include "audiosink.h"
+
+/**
+ * @brief AudioSink on the sound device, through AudioPlayer's music stream.
+ */
+class SdlAudioSink : public AudioSink {
+public:
+    const char* name() const override { return "sdl"; }
+
+    bool play(const std::vector<uint8_t>& wav, FinishedCallback onFinished = nullptr) override {
+        return player_.loadAudio(wav) && player_.play(std::move(onFinished));
+    }
+
+    void stop() override { player_.stop(); }
+
+private:
+    AudioPlayer player_;
+};
+
+/**
+ * @brief Opens the sink named by spec, or by the AUDIO_SINK environment
+ *        variable when spec is empty:
+ *
+ *     sdl          the sound device (default)
+ *     null         no output, clips take their real length
+ *     file:<dir>   like null, and every clip is written to <dir>
+ *
+ * If the device cannot be opened, the null sink is used instead, so a
+ * machine without audio runs the same code with one warning.
+ */
+inline std::unique_ptr<AudioSink> openAudioSink(std::string spec = "") {
+    if (spec.empty()) {
+        const char* env = std::getenv("AUDIO_SINK");
+        spec = env ? env : "sdl";
+    }
+    if (spec == "null") {
+        return std::unique_ptr<AudioSink>(new NullAudioSink());
+    }
+    if (spec.compare(0, 5, "file:") == 0) {
+        return std::unique_ptr<AudioSink>(new WavFileSink(spec.substr(5)));
+    }
+    if (spec != "sdl") {
+        std::cerr << "Unknown audio sink \"" << spec << "\"; using sdl." << std::endl;
+    }
+    if (!AudioEngine::instance().open()) {
+        std::cerr << "No audio device; continuing without sound (AUDIO_SINK=null)." << std::endl;
+        return std::unique_ptr<AudioSink>(new NullAudioSink());
+    }
+    return std::unique_ptr<AudioSink>(new SdlAudioSink());
+}
+
+#endif  // SDLAUDIOSINK_H
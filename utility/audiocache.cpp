@@ -0,0 +1,241 @@
+#include "audiocache.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cerrno>
+#include <sys/stat.h>
+
+const char AudioCache::DEFAULT_DIR[] = "tts_cache";
+
+AudioCache::AudioCache(const std::string& dir, uint64_t maxBytes)
+    : dir_(dir), maxBytes_(maxBytes)
+{
+    if (!dir_.empty() && dir_.back() == '/') dir_.pop_back();
+    makeDirectory(dir_);
+    loadIndex();
+}
+
+AudioCache::~AudioCache() {
+    flush();
+}
+
+bool AudioCache::makeDirectory(const std::string& path) {
+    if (mkdir(path.c_str(), 0755) == 0 || errno == EEXIST) return true;
+    std::cerr << "Failed to create cache directory: " << path << std::endl;
+    return false;
+}
+
+void AudioCache::setEngineVersion(const std::string& version) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    engineVersion_ = version;
+}
+
+std::string AudioCache::engineVersion() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return engineVersion_;
+}
+
+std::string AudioCache::canonicalKey(const SynthesisParams& params) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return canonicalKeyLocked(params);
+}
+
+std::string AudioCache::canonicalKeyLocked(const SynthesisParams& params) const {
+    // Fixed precision so 1.7 and 1.70000001 from different call sites agree.
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3)
+       << "v=" << engineVersion_
+       << "|speaker=" << params.speaker
+       << "|speed=" << params.speedScale
+       << "|volume=" << params.volumeScale
+       << "|intonation=" << params.intonationScale
+       << "|pre=" << params.prePhonemeLength
+       << "|post=" << params.postPhonemeLength;
+    // Only when set, so keys of untrimmed entries stay what they were.
+    if (params.trimSilence) ss << "|trim=1";
+    ss << "|text=" << params.text;
+    return ss.str();
+}
+
+std::string AudioCache::hashKey(const std::string& canonical) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : canonical) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return ss.str();
+}
+
+std::string AudioCache::entryPath(const std::string& hash) const {
+    return dir_ + "/" + hash.substr(0, 2) + "/" + hash + ".wav";
+}
+
+std::string AudioCache::pathFor(const SynthesisParams& params) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entryPath(hashKey(canonicalKeyLocked(params)));
+}
+
+void AudioCache::loadIndex() {
+    std::ifstream file(dir_ + "/index.json");
+    if (!file) return;
+
+    try {
+        json index;
+        file >> index;
+        engineVersion_ = index.value("engine_version", "");
+
+        // Stored least recently used first, so push_front restores the order.
+        for (const auto& item : index["entries"]) {
+            Entry entry;
+            entry.hash = item["hash"].get<std::string>();
+            entry.canonical = item["key"].get<std::string>();
+            entry.size = item["size"].get<uint64_t>();
+
+            struct stat info;
+            if (stat(entryPath(entry.hash).c_str(), &info) != 0) continue;  // removed by hand
+
+            lru_.push_front(entry);
+            entries_[entry.hash] = lru_.begin();
+            totalBytes_ += entry.size;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load audio cache index: " << e.what() << std::endl;
+        lru_.clear();
+        entries_.clear();
+        totalBytes_ = 0;
+    }
+}
+
+void AudioCache::saveIndexLocked() {
+    json index;
+    index["engine_version"] = engineVersion_;
+    index["entries"] = json::array();
+    for (auto it = lru_.rbegin(); it != lru_.rend(); ++it) {
+        index["entries"].push_back({ { "hash", it->hash }, { "key", it->canonical }, { "size", it->size } });
+    }
+
+    // Write then rename so a crash never leaves a truncated index behind.
+    std::string path = dir_ + "/index.json";
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp);
+        if (!file) {
+            std::cerr << "Failed to write audio cache index: " << temp << std::endl;
+            return;
+        }
+        file << index.dump() << std::endl;
+    }
+    std::rename(temp.c_str(), path.c_str());
+    dirty_ = false;
+    unsavedPuts_ = 0;
+}
+
+void AudioCache::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dirty_) saveIndexLocked();
+}
+
+void AudioCache::touchLocked(std::list<Entry>::iterator it) {
+    lru_.splice(lru_.begin(), lru_, it);
+}
+
+bool AudioCache::contains(const SynthesisParams& params) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string canonical = canonicalKeyLocked(params);
+    auto it = entries_.find(hashKey(canonical));
+    return it != entries_.end() && it->second->canonical == canonical;
+}
+
+bool AudioCache::get(const SynthesisParams& params, std::vector<uint8_t>& audio) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string canonical = canonicalKeyLocked(params);
+    std::string hash = hashKey(canonical);
+
+    auto it = entries_.find(hash);
+    if (it == entries_.end() || it->second->canonical != canonical) {
+        ++misses_;
+        return false;
+    }
+
+    std::ifstream file(entryPath(hash), std::ios::binary);
+    if (!file) {
+        totalBytes_ -= it->second->size;
+        lru_.erase(it->second);
+        entries_.erase(it);
+        dirty_ = true;
+        ++misses_;
+        return false;
+    }
+
+    audio.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    touchLocked(it->second);
+    dirty_ = true;
+    ++hits_;
+    return true;
+}
+
+void AudioCache::put(const SynthesisParams& params, const std::vector<uint8_t>& audio) {
+    if (audio.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string canonical = canonicalKeyLocked(params);
+    std::string hash = hashKey(canonical);
+
+    makeDirectory(dir_ + "/" + hash.substr(0, 2));
+    std::string path = entryPath(hash);
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to write cached audio: " << path << std::endl;
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(audio.data()), static_cast<std::streamsize>(audio.size()));
+    }
+
+    auto it = entries_.find(hash);
+    if (it != entries_.end()) {
+        totalBytes_ -= it->second->size;
+        lru_.erase(it->second);
+        entries_.erase(it);
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.canonical = canonical;
+    entry.size = audio.size();
+    lru_.push_front(entry);
+    entries_[hash] = lru_.begin();
+    totalBytes_ += entry.size;
+
+    evictLocked();
+
+    // Batch index rewrites; the destructor flushes whatever is left.
+    dirty_ = true;
+    if (++unsavedPuts_ >= INDEX_SAVE_INTERVAL) {
+        saveIndexLocked();
+    }
+}
+
+void AudioCache::evictLocked() {
+    while (totalBytes_ > maxBytes_ && lru_.size() > 1) {
+        const Entry& victim = lru_.back();
+        std::remove(entryPath(victim.hash).c_str());
+        totalBytes_ -= victim.size;
+        entries_.erase(victim.hash);
+        lru_.pop_back();
+    }
+}
+
+size_t AudioCache::entryCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+uint64_t AudioCache::totalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalBytes_;
+}
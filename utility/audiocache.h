@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "ttsclient.h"
+
+/**
+ * @brief Content-addressed on-disk cache of synthesized audio.
+ *
+ * Entries are keyed by a hash of every parameter that changes the audio
+ * (text, speaker, speed/volume/intonation scales, pre/post phoneme length)
+ * plus the engine version, and live in a sharded layout:
+ *
+ *     <dir>/index.json
+ *     <dir>/3f/3fa09c1d22e4b871.wav
+ *
+ * The index keeps the canonical parameter string of every entry, so a hash
+ * collision is detected instead of serving the wrong clip. Total size is
+ * capped; the least recently used entries are evicted first.
+ */
+class AudioCache {
+public:
+    static const char DEFAULT_DIR[];
+    static const uint64_t DEFAULT_MAX_BYTES = 256ULL * 1024 * 1024;
+    static const size_t INDEX_SAVE_INTERVAL = 32;
+
+    explicit AudioCache(const std::string& dir = DEFAULT_DIR, uint64_t maxBytes = DEFAULT_MAX_BYTES);
+    ~AudioCache();
+
+    AudioCache(const AudioCache&) = delete;
+    AudioCache& operator=(const AudioCache&) = delete;
+
+    void setEngineVersion(const std::string& version);
+    std::string engineVersion() const;
+
+    bool get(const SynthesisParams& params, std::vector<uint8_t>& audio);
+    bool contains(const SynthesisParams& params) const;
+    void put(const SynthesisParams& params, const std::vector<uint8_t>& audio);
+    void flush();
+
+    std::string pathFor(const SynthesisParams& params) const;
+    size_t entryCount() const;
+    uint64_t totalBytes() const;
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+    /** @brief The parameter string entries are keyed by; safe while the version changes. */
+    std::string canonicalKey(const SynthesisParams& params) const;
+    static std::string hashKey(const std::string& canonical);
+
+private:
+    struct Entry {
+        std::string hash;
+        std::string canonical;
+        uint64_t size = 0;
+    };
+
+    std::string canonicalKeyLocked(const SynthesisParams& params) const;
+    std::string entryPath(const std::string& hash) const;
+    void loadIndex();
+    void saveIndexLocked();
+    void touchLocked(std::list<Entry>::iterator it);
+    void evictLocked();
+    static bool makeDirectory(const std::string& path);
+
+    std::string dir_;
+    uint64_t maxBytes_;
+    std::string engineVersion_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  /**< Most recently used first. */
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries_;
+    uint64_t totalBytes_ = 0;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    bool dirty_ = false;
+    size_t unsavedPuts_ = 0;
+};
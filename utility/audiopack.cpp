@@ -0,0 +1,207 @@
+#include "audiopack.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const char AudioPack::MAGIC[4] = { 'J', 'T', 'P', 'K' };
+const char AudioPack::DEFAULT_FILE[] = "wav.pack";
+
+namespace {
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+const size_t ALIGNMENT = 16;
+
+size_t alignUp(size_t value) {
+    return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+uint32_t read32(const std::string& data, size_t at) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) value = (value << 8) | static_cast<unsigned char>(data[at + i]);
+    return value;
+}
+
+// Finds the fmt chunk; false if this is not a PCM-style RIFF/WAVE file.
+bool readFormat(const std::string& wav, AudioPackEntry& entry) {
+    if (wav.size() < 12 || wav.compare(0, 4, "RIFF") != 0 || wav.compare(8, 4, "WAVE") != 0) return false;
+    size_t at = 12;
+    while (at + 8 <= wav.size()) {
+        uint32_t chunkBytes = read32(wav, at + 4);
+        if (wav.compare(at, 4, "fmt ") == 0 && chunkBytes >= 16 && at + 24 <= wav.size()) {
+            entry.channels = static_cast<uint16_t>(read32(wav, at + 10) & 0xFFFF);
+            entry.sampleRate = read32(wav, at + 12);
+            entry.bitsPerSample = static_cast<uint16_t>(read32(wav, at + 22) & 0xFFFF);
+            return true;
+        }
+        at += 8 + chunkBytes + (chunkBytes & 1);
+    }
+    return false;
+}
+
+std::string stripExtension(const std::string& name) {
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0) return name.substr(0, name.size() - 4);
+    return name;
+}
+
+}  // namespace
+
+AudioPack::~AudioPack() {
+    close();
+}
+
+int AudioPack::build(const std::string& directory, const std::string& packFile, std::string* error) {
+    auto fail = [&](const std::string& reason) {
+        if (error) *error = reason;
+        return -1;
+    };
+
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return fail("cannot open directory " + directory);
+    std::vector<std::string> names;
+    while (dirent* item = readdir(dir)) {
+        std::string name = item->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0) names.push_back(name);
+    }
+    closedir(dir);
+    // The index is searched by clip name, so order by that rather than file name.
+    std::sort(names.begin(), names.end(), [](const std::string& a, const std::string& b) {
+        return stripExtension(a) < stripExtension(b);
+    });
+
+    std::vector<AudioPackEntry> entries;
+    std::vector<std::string> clips;
+    for (const auto& name : names) {
+        std::string clipName = stripExtension(name);
+        if (clipName.size() >= AudioPackEntry::NAME_BYTES) {
+            std::cerr << "Skipping " << name << ": name longer than " << AudioPackEntry::NAME_BYTES - 1 << " bytes" << std::endl;
+            continue;
+        }
+
+        std::ifstream file(directory + "/" + name, std::ios::binary);
+        std::string wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        AudioPackEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        if (!readFormat(wav, entry)) {
+            std::cerr << "Skipping " << name << ": not a WAV file" << std::endl;
+            continue;
+        }
+        std::memcpy(entry.name, clipName.c_str(), clipName.size());
+        entry.length = wav.size();
+
+        entries.push_back(entry);
+        clips.push_back(std::move(wav));
+    }
+
+    size_t offset = alignUp(sizeof(PackHeader) + entries.size() * sizeof(AudioPackEntry));
+    for (auto& entry : entries) {
+        entry.offset = offset;
+        offset = alignUp(offset + entry.length);
+    }
+
+    PackHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.count = static_cast<uint32_t>(entries.size());
+    header.reserved = 0;
+
+    // Write then rename so a running reader never maps a half-written pack.
+    std::string temp = packFile + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary);
+        if (!out) return fail("cannot write " + temp);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(AudioPackEntry)));
+
+        size_t written = sizeof(header) + entries.size() * sizeof(AudioPackEntry);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            std::string padding(entries[i].offset - written, '\0');
+            out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+            out.write(clips[i].data(), static_cast<std::streamsize>(clips[i].size()));
+            written = entries[i].offset + entries[i].length;
+        }
+        if (!out) return fail("failed writing " + temp);
+    }
+    if (std::rename(temp.c_str(), packFile.c_str()) != 0) return fail("cannot rename " + temp);
+    return static_cast<int>(entries.size());
+}
+
+bool AudioPack::open(const std::string& packFile) {
+    close();
+
+    int fd = ::open(packFile.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(PackHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map audio pack: " << packFile << std::endl;
+        return false;
+    }
+
+    const uint8_t* base = static_cast<const uint8_t*>(mapped);
+    const PackHeader* header = reinterpret_cast<const PackHeader*>(base);
+    size_t indexEnd = sizeof(PackHeader) + static_cast<size_t>(header->count) * sizeof(AudioPackEntry);
+    bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header->version == VERSION && indexEnd <= bytes;
+
+    const AudioPackEntry* entries = reinterpret_cast<const AudioPackEntry*>(base + sizeof(PackHeader));
+    for (size_t i = 0; valid && i < header->count; ++i) {
+        // Compared without adding, which could wrap past a crafted offset.
+        valid = entries[i].offset >= indexEnd && entries[i].offset <= bytes &&
+                entries[i].length <= bytes - entries[i].offset &&
+                entries[i].name[AudioPackEntry::NAME_BYTES - 1] == '\0';
+    }
+    if (!valid) {
+        std::cerr << "Invalid audio pack: " << packFile << std::endl;
+        munmap(mapped, bytes);
+        return false;
+    }
+
+    // Clips are small and all of them are prompts; read them in ahead of first play.
+    madvise(mapped, bytes, MADV_WILLNEED);
+
+    base_ = base;
+    mappedBytes_ = bytes;
+    entries_ = entries;
+    count_ = header->count;
+    return true;
+}
+
+void AudioPack::close() {
+    if (base_) {
+        munmap(const_cast<uint8_t*>(base_), mappedBytes_);
+    }
+    base_ = nullptr;
+    mappedBytes_ = 0;
+    entries_ = nullptr;
+    count_ = 0;
+}
+
+const AudioPackEntry* AudioPack::find(const std::string& name) const {
+    std::string key = stripExtension(name);
+    const AudioPackEntry* end = entries_ + count_;
+    const AudioPackEntry* it = std::lower_bound(entries_, end, key,
+        [](const AudioPackEntry& entry, const std::string& value) { return std::strcmp(entry.name, value.c_str()) < 0; });
+    if (it != end && key == it->name) return it;
+    return nullptr;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief One clip in an audio pack. Fixed size so the index is read in place.
+ */
+struct AudioPackEntry {
+    static const size_t NAME_BYTES = 48;
+
+    char name[NAME_BYTES];  /**< File name without ".wav", NUL-terminated. */
+    uint64_t offset;        /**< From the start of the pack; 16-byte aligned. */
+    uint64_t length;        /**< Whole WAV file, header included. */
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t bitsPerSample;
+};
+
+/**
+ * @brief Read-only archive of the prompt clips in wav/, mapped with one mmap.
+ *
+ * Layout (little-endian):
+ *
+ *     "JTPK" | version u32 | count u32 | reserved u32
+ *     AudioPackEntry[count]   sorted by name
+ *     clip data               each a complete WAV, 16-byte aligned
+ *
+ * Opening the pack costs one open + mmap; finding a clip is a binary search
+ * over the mapped index, and its bytes can be handed to SDL_RWFromConstMem
+ * without a copy. Build one with build() or ./pack_audio.
+ */
+class AudioPack {
+public:
+    static const char MAGIC[4];
+    static const uint32_t VERSION = 1;
+    static const char DEFAULT_FILE[];
+
+    AudioPack() = default;
+    ~AudioPack();
+
+    AudioPack(const AudioPack&) = delete;
+    AudioPack& operator=(const AudioPack&) = delete;
+
+    /**
+     * @brief Packs every *.wav in a directory.
+     * @return The number of clips packed, or -1 on failure (reason in error).
+     */
+    static int build(const std::string& directory, const std::string& packFile, std::string* error = nullptr);
+
+    bool open(const std::string& packFile);
+    void close();
+    bool isOpen() const { return base_ != nullptr; }
+
+    size_t size() const { return count_; }
+    const AudioPackEntry& entry(size_t i) const { return entries_[i]; }
+
+    /** @param name Clip name, with or without ".wav". @return nullptr if absent. */
+    const AudioPackEntry* find(const std::string& name) const;
+    const uint8_t* data(const AudioPackEntry& entry) const { return base_ + entry.offset; }
+
+private:
+    const uint8_t* base_ = nullptr;
+    size_t mappedBytes_ = 0;
+    const AudioPackEntry* entries_ = nullptr;
+    size_t count_ = 0;
+};
@@ -0,0 +1,111 @@
+#include "audiosink.h"
+#include "wavpcm.h"
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <cstdio>
+
+double wavSeconds(const std::vector<uint8_t>& wav) {
+    PcmLayout layout;
+    if (!readPcm16(wav, layout) || layout.sampleRate == 0) return -1.0;
+    return static_cast<double>(layout.frames()) / layout.sampleRate;
+}
+
+std::future<void> AudioSink::playAsync(const std::vector<uint8_t>& wav) {
+    // std::function must be copyable, hence the shared promise.
+    std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+    std::future<void> future = done->get_future();
+    if (!play(wav, [done]() { done->set_value(); })) {
+        done->set_value();
+    }
+    return future;
+}
+
+NullAudioSink::NullAudioSink() {
+    timer_ = std::thread(&NullAudioSink::run, this);
+}
+
+NullAudioSink::~NullAudioSink() {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (timer_.joinable()) {
+        timer_.join();
+    }
+}
+
+bool NullAudioSink::play(const std::vector<uint8_t>& wav, FinishedCallback onFinished) {
+    double seconds = wavSeconds(wav);
+    if (seconds < 0) {
+        std::cerr << "Failed to play audio: not a 16-bit PCM WAV" << std::endl;
+        return false;
+    }
+    stop();
+    played(wav);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        endsAt_ = std::chrono::steady_clock::now() +
+                  std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        onFinished_ = std::move(onFinished);
+        playing_ = true;
+        ++clipsPlayed_;
+        secondsPlayed_ += seconds;
+    }
+    wake_.notify_all();
+    return true;
+}
+
+void NullAudioSink::stop() {
+    FinishedCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!playing_) return;
+        playing_ = false;
+        callback.swap(onFinished_);
+    }
+    wake_.notify_all();
+    if (callback) callback();
+}
+
+size_t NullAudioSink::clipsPlayed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clipsPlayed_;
+}
+
+double NullAudioSink::secondsPlayed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return secondsPlayed_;
+}
+
+void NullAudioSink::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (!playing_) {
+            wake_.wait(lock);
+            continue;
+        }
+        wake_.wait_until(lock, endsAt_);
+        // A new clip may have moved the deadline while this thread slept.
+        if (playing_ && std::chrono::steady_clock::now() >= endsAt_) {
+            playing_ = false;
+            FinishedCallback callback;
+            callback.swap(onFinished_);
+            lock.unlock();
+            if (callback) callback();
+            lock.lock();
+        }
+    }
+}
+
+void WavFileSink::played(const std::vector<uint8_t>& wav) {
+    char name[16];
+    std::snprintf(name, sizeof(name), "%04zu.wav", ++written_);
+    std::string path = directory_ + "/" + name;
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(wav.data()), static_cast<std::streamsize>(wav.size()))) {
+        std::cerr << "Failed to write " << path << std::endl;
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Where played audio goes: the sound device, nowhere, or files.
+ *
+ * A sink plays one WAV at a time, like AudioPlayer's music stream: starting
+ * a clip stops the one before it. Code that only needs "play this and tell
+ * me when it is done" (the quiz, the tutor) takes an AudioSink, so it runs
+ * the same with or without a sound card. Pick one with openAudioSink()
+ * (SdlAudioSink.h).
+ */
+class AudioSink {
+public:
+    /** Runs once when the clip ends or is stopped, possibly on another thread. */
+    typedef std::function<void()> FinishedCallback;
+
+    virtual ~AudioSink() = default;
+
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Starts a clip; whatever was playing is stopped first.
+     * @return False if the clip could not start; onFinished is not called then.
+     */
+    virtual bool play(const std::vector<uint8_t>& wav, FinishedCallback onFinished = nullptr) = 0;
+
+    /** @brief Stops the current clip, if any, running its callback. */
+    virtual void stop() = 0;
+
+    /** @return Becomes ready when the clip ends or is stopped; ready at once if it cannot start. */
+    std::future<void> playAsync(const std::vector<uint8_t>& wav);
+};
+
+/**
+ * @brief Plays nothing, but takes as long as the clip would.
+ *
+ * A clip "ends" after its duration (frames / sample rate, read from the WAV
+ * header) on a timer thread, so callers waiting on playAsync() see the same
+ * pacing as with a device. For headless build and benchmark machines where
+ * SDL cannot open audio.
+ */
+class NullAudioSink : public AudioSink {
+public:
+    NullAudioSink();
+    ~NullAudioSink();
+
+    NullAudioSink(const NullAudioSink&) = delete;
+    NullAudioSink& operator=(const NullAudioSink&) = delete;
+
+    const char* name() const override { return "null"; }
+    bool play(const std::vector<uint8_t>& wav, FinishedCallback onFinished = nullptr) override;
+    void stop() override;
+
+    /** @return Clips started so far and their total length. */
+    size_t clipsPlayed() const;
+    double secondsPlayed() const;
+
+protected:
+    /** @brief Hook for sinks that also keep the audio; called before the clip starts. */
+    virtual void played(const std::vector<uint8_t>&) {}
+
+private:
+    void run();
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::chrono::steady_clock::time_point endsAt_;
+    FinishedCallback onFinished_;
+    bool playing_ = false;
+    bool stop_ = false;
+    size_t clipsPlayed_ = 0;
+    double secondsPlayed_ = 0.0;
+    std::thread timer_;
+};
+
+/**
+ * @brief A NullAudioSink that also writes every clip it plays to
+ *        <directory>/0001.wav, 0002.wav, ... for inspection.
+ */
+class WavFileSink : public NullAudioSink {
+public:
+    /** The directory must exist. */
+    explicit WavFileSink(const std::string& directory) : directory_(directory) {}
+
+    const char* name() const override { return "file"; }
+
+protected:
+    void played(const std::vector<uint8_t>& wav) override;
+
+private:
+    std::string directory_;
+    size_t written_ = 0;
+};
+
+/** @return Length of a 16-bit PCM WAV in seconds, or -1 if it is not one. */
+double wavSeconds(const std::vector<uint8_t>& wav);
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+///             Japanese Text to Speech - batch synthesizer
+///
+///
+/// Synthesizes every entry of a words.txt batch file into <name>.wav with
+/// several requests in flight at once. Repeated text is synthesized once
+/// and written to every file that asks for it.
+///
+/// Usage:   ./batch_tts [words.txt] [output_dir] [concurrency] [voice]
+///
+/// voice is a Persona.json name ("Mochiko-san", "Kyushu Sora/Sexy") or an id.
+///
+/// @see     words.txt
+///          https://voicevox.github.io/voicevox_engine/api/
+///
+/// @file    batch_tts.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <cerrno>
+#include <sys/stat.h>
+#include "ttsclient.h"
+#include "audiocache.h"
+#include "querycache.h"
+#include "speakercatalog.h"
+
+// Longest file name taken from the text or the name column, in characters.
+static const size_t MAX_NAME_CHARACTERS = 10;
+
+struct BatchEntry {
+    std::string text;
+    std::string fileName;
+};
+
+static std::string trim(const std::string& str) {
+    const char* whitespace = " \t\r\n";
+    size_t begin = str.find_first_not_of(whitespace);
+    if (begin == std::string::npos) return "";
+    size_t end = str.find_last_not_of(whitespace);
+    return str.substr(begin, end - begin + 1);
+}
+
+// Keeps the first count UTF-8 code points, so a Japanese name is never cut mid-character.
+static std::string firstCharacters(const std::string& str, size_t count) {
+    size_t characters = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        bool leadByte = (static_cast<unsigned char>(str[i]) & 0xC0) != 0x80;
+        if (leadByte && characters++ == count) return str.substr(0, i);
+    }
+    return str;
+}
+
+// words.txt: "text:name" per line; the name is optional, "#" and "//" lines are comments.
+static std::vector<BatchEntry> loadBatch(const std::string& filename) {
+    std::vector<BatchEntry> entries;
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open batch file: " << filename << std::endl;
+        return entries;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line.compare(0, 1, "#") == 0 || line.compare(0, 2, "//") == 0) continue;
+
+        size_t colon = line.find(':');
+        BatchEntry entry;
+        entry.text = trim(line.substr(0, colon));
+        std::string name = colon == std::string::npos ? "" : trim(line.substr(colon + 1));
+        entry.fileName = firstCharacters(name.empty() ? entry.text : name, MAX_NAME_CHARACTERS) + ".wav";
+        if (!entry.text.empty()) entries.push_back(entry);
+    }
+    return entries;
+}
+
+static bool writeFile(const std::string& path, const std::vector<uint8_t>& audio) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(audio.data()), static_cast<std::streamsize>(audio.size()));
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char* argv[]) {
+    std::string batchFile = argc > 1 ? argv[1] : "words.txt";
+    std::string outputDir = argc > 2 ? argv[2] : ".";
+    size_t concurrency = argc > 3 ? std::stoul(argv[3]) : 4;
+    std::string voiceName = argc > 4 ? argv[4] : "Mochiko-san";
+
+    SpeakerCatalog speakers;
+    speakers.load();
+    int speaker = speakers.resolve(voiceName);
+    if (speaker < 0) {
+        std::cerr << "Unknown voice: " << voiceName << std::endl;
+        return 1;
+    }
+
+    std::vector<BatchEntry> entries = loadBatch(batchFile);
+    if (entries.empty()) {
+        std::cerr << "Nothing to synthesize in " << batchFile << std::endl;
+        return 1;
+    }
+    if (mkdir(outputDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Failed to create output directory: " << outputDir << std::endl;
+        return 1;
+    }
+
+    AudioCache cache;  // caches are declared first so they outlive the client
+    QueryCache queries;
+    VoiceClient voice(concurrency);
+    std::future<size_t> speakerReady = warmUpSpeakers({ speaker }, voice.baseUrl());
+    std::string version = voice.fetchEngineVersion();
+    if (version.empty()) {
+        std::cerr << "VOICEVOX engine is not reachable at " << voice.baseUrl() << std::endl;
+        return 1;
+    }
+    cache.setEngineVersion(version);
+    queries.setEngineVersion(version);
+    voice.setCache(&cache);
+    voice.setQueryCache(&queries);
+
+    // Each distinct text is synthesized once, whatever number of files it feeds.
+    std::map<std::string, std::vector<std::string>> filesByText;
+    std::vector<std::string> texts;
+    for (const auto& entry : entries) {
+        std::vector<std::string>& files = filesByText[entry.text];
+        if (files.empty()) texts.push_back(entry.text);
+        files.push_back(entry.fileName);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<SynthesisResult>> results;
+    for (const auto& text : texts) {
+        SynthesisParams params;
+        params.text = text;
+        params.speaker = speaker;
+        params.intonationScale = 2.0;
+        results.push_back(voice.synthesize(params));
+    }
+
+    size_t written = 0, cached = 0, failed = 0;
+    uint64_t audioBytes = 0;
+    std::vector<double> latencies;
+    for (size_t i = 0; i < results.size(); ++i) {
+        SynthesisResult result = results[i].get();
+        if (!result.ok) {
+            std::cerr << "Failed: " << texts[i] << " (" << result.error << ")" << std::endl;
+            ++failed;
+            continue;
+        }
+        if (result.cached) {
+            ++cached;
+        } else {
+            latencies.push_back(result.latencyMs);
+        }
+        audioBytes += result.audio.size();
+
+        for (const auto& fileName : filesByText[texts[i]]) {
+            std::string path = outputDir + "/" + fileName;
+            if (writeFile(path, result.audio)) {
+                std::cout << "Audio file saved: " << path << std::endl;
+                ++written;
+            } else {
+                std::cerr << "Failed to write " << path << std::endl;
+                ++failed;
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << entries.size() << " entries, " << texts.size() << " distinct, " << written << " files written, "
+              << cached << " from cache, " << failed << " failed in " << seconds << " s ("
+              << (seconds > 0 ? texts.size() / seconds : 0) << " utterances/s, "
+              << audioBytes / 1024 << " KiB)" << std::endl;
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "Synthesis latency: p50 " << latencies[latencies.size() / 2] << " ms, max "
+                  << latencies.back() << " ms" << std::endl;
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,302 @@
+///////////////////////////////////////////////////////////////////////////////
+///             Mock VOICEVOX engine
+///
+///
+/// A small stand-in for the VOICEVOX engine so TTS code can be tested and
+/// benchmarked without the real one. Speaks HTTP/1.1 with keep-alive and
+/// implements the endpoints this repo calls:
+///
+///   GET  /version                 "0.14.3-mock"
+///   POST /audio_query?text&speaker  accent-phrase JSON echoing the text
+///   POST /audio_query_from_preset   the same, for voiceSynth.py
+///   GET  /presets                 one preset (id 1)
+///   POST /synthesis?speaker       a canned WAV from wav/ (or a silent one)
+///   POST /initialize_speaker      204
+///   GET  /is_initialized_speaker  true
+///
+/// Usage:   ./mock_voicevox [--port 50021] [--latency-ms 0]
+///                          [--synthesis-latency-ms N] [--payload-bytes N]
+///                          [--wav-dir wav]
+///
+/// --latency-ms delays every request; --synthesis-latency-ms overrides it
+/// for /synthesis, which is the slow call on a real engine. With
+/// --payload-bytes every synthesis returns a silent WAV of about that size
+/// instead of the canned clips.
+///
+/// @see     https://voicevox.github.io/voicevox_engine/api/
+///
+/// @file    mock_voicevox.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+struct MockOptions {
+    int port = 50021;
+    int latencyMs = 0;
+    int synthesisLatencyMs = -1;  /**< -1: same as latencyMs. */
+    size_t payloadBytes = 0;      /**< 0: serve the canned clips. */
+    std::string wavDir = "wav";
+};
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::map<std::string, std::string> query;
+    std::string body;
+    bool keepAlive = true;
+};
+
+static MockOptions options;
+static std::vector<std::string> cannedWavs;
+
+static std::string urlDecode(const std::string& value) {
+    std::string decoded;
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size()) {
+            decoded += static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else if (value[i] == '+') {
+            decoded += ' ';
+        } else {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+static std::string lowercase(std::string value) {
+    for (auto& c : value) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return value;
+}
+
+// 24 kHz mono 16-bit, the format VOICEVOX produces.
+static std::string silentWav(size_t totalBytes) {
+    uint32_t dataBytes = static_cast<uint32_t>(totalBytes > 44 ? (totalBytes - 44) & ~1u : 0);
+    std::string wav(44 + dataBytes, '\0');
+    auto put32 = [&](size_t at, uint32_t v) { for (int i = 0; i < 4; ++i) wav[at + i] = static_cast<char>(v >> (8 * i)); };
+    auto put16 = [&](size_t at, uint16_t v) { wav[at] = static_cast<char>(v); wav[at + 1] = static_cast<char>(v >> 8); };
+    std::memcpy(&wav[0], "RIFF", 4);
+    put32(4, 36 + dataBytes);
+    std::memcpy(&wav[8], "WAVEfmt ", 8);
+    put32(16, 16);
+    put16(20, 1);
+    put16(22, 1);
+    put32(24, 24000);
+    put32(28, 48000);
+    put16(32, 2);
+    put16(34, 16);
+    std::memcpy(&wav[36], "data", 4);
+    put32(40, dataBytes);
+    return wav;
+}
+
+static void loadCannedWavs(const std::string& dir) {
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) return;
+    while (dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name.size() < 4 || name.compare(name.size() - 4, 4, ".wav") != 0) continue;
+        std::ifstream file(dir + "/" + name, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!data.empty()) cannedWavs.push_back(data);
+    }
+    closedir(handle);
+}
+
+// Reads one request; false when the peer closed the connection or sent garbage.
+static bool readRequest(int fd, std::string& buffer, HttpRequest& request) {
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        char chunk[4096];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+
+    std::istringstream head(buffer.substr(0, headerEnd));
+    std::string line, target, version;
+    std::getline(head, line);
+    std::istringstream requestLine(line);
+    requestLine >> request.method >> target >> version;
+    request.keepAlive = version != "HTTP/1.0";
+
+    size_t contentLength = 0;
+    while (std::getline(head, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = lowercase(line.substr(0, colon));
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(' '));
+        if (!value.empty() && value.back() == '\r') value.pop_back();
+        if (name == "content-length") contentLength = std::stoul(value);
+        if (name == "connection") request.keepAlive = lowercase(value) != "close";
+    }
+
+    buffer.erase(0, headerEnd + 4);
+    while (buffer.size() < contentLength) {
+        char chunk[4096];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    request.body = buffer.substr(0, contentLength);
+    buffer.erase(0, contentLength);
+
+    size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    request.query.clear();
+    if (question != std::string::npos) {
+        std::istringstream params(target.substr(question + 1));
+        std::string pair;
+        while (std::getline(params, pair, '&')) {
+            size_t equals = pair.find('=');
+            request.query[pair.substr(0, equals)] = equals == std::string::npos ? "" : urlDecode(pair.substr(equals + 1));
+        }
+    }
+    return true;
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool respond(int fd, int status, const std::string& contentType, const std::string& body, bool keepAlive) {
+    const char* reason = status == 200 ? "OK" : status == 204 ? "No Content" : status == 404 ? "Not Found" : "Unprocessable Entity";
+    std::ostringstream head;
+    head << "HTTP/1.1 " << status << " " << reason << "\r\n"
+         << "Content-Length: " << body.size() << "\r\n"
+         << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n";
+    if (!contentType.empty()) head << "Content-Type: " << contentType << "\r\n";
+    head << "\r\n";
+    return sendAll(fd, head.str() + body);
+}
+
+static json audioQuery(const std::string& text) {
+    return {
+        { "accent_phrases", json::array({ { { "moras", json::array() }, { "accent", 1 }, { "text", text } } }) },
+        { "speedScale", 1.0 },
+        { "pitchScale", 0.0 },
+        { "intonationScale", 1.0 },
+        { "volumeScale", 1.0 },
+        { "prePhonemeLength", 0.1 },
+        { "postPhonemeLength", 0.1 },
+        { "outputSamplingRate", 24000 },
+        { "outputStereo", false },
+        { "kana", text }
+    };
+}
+
+static void serveConnection(int fd) {
+    std::string buffer;
+    HttpRequest request;
+    while (readRequest(fd, buffer, request)) {
+        bool synthesis = request.path == "/synthesis";
+        int delay = synthesis && options.synthesisLatencyMs >= 0 ? options.synthesisLatencyMs : options.latencyMs;
+        if (delay > 0) std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+        bool ok = true;
+        if (request.method == "GET" && request.path == "/version") {
+            ok = respond(fd, 200, "application/json", "\"0.14.3-mock\"", request.keepAlive);
+        } else if (request.method == "POST" && (request.path == "/audio_query" || request.path == "/audio_query_from_preset")) {
+            if (request.query["text"].empty()) {
+                ok = respond(fd, 422, "application/json", "{\"detail\":\"text is required\"}", request.keepAlive);
+            } else {
+                ok = respond(fd, 200, "application/json", audioQuery(request.query["text"]).dump(), request.keepAlive);
+            }
+        } else if (request.method == "POST" && synthesis) {
+            if (!json::accept(request.body)) {
+                ok = respond(fd, 422, "application/json", "{\"detail\":\"invalid audio_query\"}", request.keepAlive);
+            } else if (options.payloadBytes > 0 || cannedWavs.empty()) {
+                ok = respond(fd, 200, "audio/wav", silentWav(options.payloadBytes ? options.payloadBytes : 24044), request.keepAlive);
+            } else {
+                // Same text, same clip: keeps cache tests deterministic.
+                size_t pick = std::hash<std::string>()(request.body) % cannedWavs.size();
+                ok = respond(fd, 200, "audio/wav", cannedWavs[pick], request.keepAlive);
+            }
+        } else if (request.method == "POST" && request.path == "/initialize_speaker") {
+            ok = respond(fd, 204, "", "", request.keepAlive);
+        } else if (request.method == "GET" && request.path == "/presets") {
+            json preset = { { "id", 1 }, { "name", "mock" }, { "speaker_uuid", "" }, { "style_id", 17 },
+                            { "speedScale", 1.0 }, { "pitchScale", 0.0 }, { "intonationScale", 1.0 }, { "volumeScale", 1.0 },
+                            { "prePhonemeLength", 0.1 }, { "postPhonemeLength", 0.1 } };
+            ok = respond(fd, 200, "application/json", json::array({ preset }).dump(), request.keepAlive);
+        } else if (request.method == "GET" && request.path == "/is_initialized_speaker") {
+            ok = respond(fd, 200, "application/json", "true", request.keepAlive);
+        } else {
+            ok = respond(fd, 404, "application/json", "{\"detail\":\"Not Found\"}", request.keepAlive);
+        }
+        if (!ok || !request.keepAlive) break;
+    }
+    close(fd);
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--port") options.port = std::stoi(value);
+        else if (flag == "--latency-ms") options.latencyMs = std::stoi(value);
+        else if (flag == "--synthesis-latency-ms") options.synthesisLatencyMs = std::stoi(value);
+        else if (flag == "--payload-bytes") options.payloadBytes = std::stoul(value);
+        else if (flag == "--wav-dir") options.wavDir = value;
+        else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+    loadCannedWavs(options.wavDir);
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on 127.0.0.1:" << options.port << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    std::cout << "Mock VOICEVOX listening on http://127.0.0.1:" << options.port << "/ ("
+              << cannedWavs.size() << " canned WAVs, latency " << options.latencyMs << " ms)" << std::endl;
+
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        // Responses are written in one piece; don't let Nagle hold them back.
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        std::thread(serveConnection, fd).detach();
+    }
+    close(listener);
+    return 0;
+}
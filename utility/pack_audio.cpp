@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+///             Audio pack builder
+///
+///
+/// Packs the prompt clips of a directory into one indexed, mmap-able file.
+///
+/// Usage:   ./pack_audio <wav_dir> [pack_file]      build (default wav.pack)
+///          ./pack_audio --list [pack_file]         print the index
+///
+/// @see     audiopack.h
+///
+/// @file    pack_audio.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "audiopack.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <wav_dir> [pack_file] | --list [pack_file]" << std::endl;
+        return 1;
+    }
+
+    std::string first = argv[1];
+    std::string packFile = argc > 2 ? argv[2] : AudioPack::DEFAULT_FILE;
+
+    if (first != "--list") {
+        std::string error;
+        int packed = AudioPack::build(first, packFile, &error);
+        if (packed < 0) {
+            std::cerr << "Failed to build " << packFile << ": " << error << std::endl;
+            return 1;
+        }
+        std::cout << "Packed " << packed << " clips from " << first << " into " << packFile << std::endl;
+    }
+
+    AudioPack pack;
+    if (!pack.open(packFile)) {
+        std::cerr << "Failed to open " << packFile << std::endl;
+        return 1;
+    }
+    if (first == "--list") {
+        for (size_t i = 0; i < pack.size(); ++i) {
+            const AudioPackEntry& entry = pack.entry(i);
+            std::cout << std::left << std::setw(24) << entry.name << std::right
+                      << std::setw(10) << entry.offset << std::setw(10) << entry.length << "  "
+                      << entry.sampleRate << " Hz, " << entry.channels << " ch, "
+                      << entry.bitsPerSample << " bit" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "querycache.h"
+#include "audiocache.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <cerrno>
+#include <sys/stat.h>
+
+const char QueryCache::DEFAULT_DIR[] = "tts_cache/queries";
+
+QueryCache::QueryCache(const std::string& dir, size_t memoryEntries)
+    : dir_(dir), capacity_(std::max<size_t>(1, memoryEntries))
+{
+    if (!dir_.empty() && dir_.back() == '/') dir_.pop_back();
+
+    // Create every component, so the default tts_cache/queries works on a fresh checkout.
+    for (size_t slash = dir_.find('/', 1); ; slash = dir_.find('/', slash + 1)) {
+        std::string path = dir_.substr(0, slash);
+        if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "Failed to create query cache directory: " << path << std::endl;
+            break;
+        }
+        if (slash == std::string::npos) break;
+    }
+}
+
+void QueryCache::setEngineVersion(const std::string& version) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (version != engineVersion_) {
+        lru_.clear();
+        entries_.clear();
+    }
+    engineVersion_ = version;
+}
+
+std::string QueryCache::canonicalKey(const std::string& text, int speaker) const {
+    return "v=" + engineVersion_ + "|speaker=" + std::to_string(speaker) + "|text=" + text;
+}
+
+std::string QueryCache::entryPath(const std::string& canonical) const {
+    return dir_ + "/" + AudioCache::hashKey(canonical) + ".json";
+}
+
+void QueryCache::rememberLocked(const std::string& canonical, const json& query) {
+    auto it = entries_.find(canonical);
+    if (it != entries_.end()) {
+        lru_.erase(it->second);
+        entries_.erase(it);
+    }
+    lru_.emplace_front(canonical, query);
+    entries_[canonical] = lru_.begin();
+
+    while (lru_.size() > capacity_) {
+        entries_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+bool QueryCache::get(const std::string& text, int speaker, json& query) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string canonical = canonicalKey(text, speaker);
+
+    auto it = entries_.find(canonical);
+    if (it != entries_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        query = it->second->second;
+        ++hits_;
+        return true;
+    }
+
+    std::ifstream file(entryPath(canonical));
+    if (file) {
+        try {
+            json stored;
+            file >> stored;
+            if (stored.value("key", "") == canonical && stored.contains("query")) {
+                query = stored["query"];
+                rememberLocked(canonical, query);
+                ++hits_;
+                return true;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring unreadable cached audio_query: " << e.what() << std::endl;
+        }
+    }
+
+    ++misses_;
+    return false;
+}
+
+void QueryCache::put(const std::string& text, int speaker, const json& query) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string canonical = canonicalKey(text, speaker);
+    rememberLocked(canonical, query);
+
+    // Write then rename so a reader never sees half an entry.
+    std::string path = entryPath(canonical);
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp);
+        if (!file) {
+            std::cerr << "Failed to write cached audio_query: " << temp << std::endl;
+            return;
+        }
+        file << json{ { "key", canonical }, { "query", query } }.dump() << std::endl;
+    }
+    std::rename(temp.c_str(), path.c_str());
+}
+
+size_t QueryCache::memoryEntries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Cache of VOICEVOX audio_query responses.
+ *
+ * The accent-phrase structure returned by audio_query depends only on the
+ * text, the speaker and the engine version; speed, volume, intonation and
+ * phoneme lengths are overrides applied on top of it. Caching the raw
+ * response lets a replay at another speed skip straight to /synthesis.
+ *
+ * Recent entries are kept in memory (LRU, bounded by entry count); every
+ * entry is also written to <dir>/<hash>.json so it survives restarts.
+ * A disk entry stores its canonical key, so a hash collision is a miss.
+ */
+class QueryCache {
+public:
+    static const char DEFAULT_DIR[];
+    static const size_t DEFAULT_MEMORY_ENTRIES = 512;
+
+    explicit QueryCache(const std::string& dir = DEFAULT_DIR, size_t memoryEntries = DEFAULT_MEMORY_ENTRIES);
+
+    QueryCache(const QueryCache&) = delete;
+    QueryCache& operator=(const QueryCache&) = delete;
+
+    void setEngineVersion(const std::string& version);
+
+    /** @return True and the raw (override-free) audio_query JSON on a hit. */
+    bool get(const std::string& text, int speaker, json& query);
+    void put(const std::string& text, int speaker, const json& query);
+
+    size_t memoryEntries() const;
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+    std::string canonicalKey(const std::string& text, int speaker) const;
+
+private:
+    typedef std::pair<std::string, json> Entry;  /**< Canonical key, raw query. */
+
+    std::string entryPath(const std::string& canonical) const;
+    void rememberLocked(const std::string& canonical, const json& query);
+
+    std::string dir_;
+    size_t capacity_;
+    std::string engineVersion_;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  /**< Most recently used first. */
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
@@ -0,0 +1,90 @@
+#include "silencetrim.h"
+#include "wavpcm.h"
+#include <cmath>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+void write32(std::vector<uint8_t>& data, size_t at, uint32_t value) {
+    for (int i = 0; i < 4; ++i) data[at + i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+}  // namespace
+
+uint64_t sampleEnergyScalar(const int16_t* samples, size_t count) {
+    uint64_t energy = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int32_t sample = samples[i];
+        energy += static_cast<uint64_t>(sample * sample);
+    }
+    return energy;
+}
+
+#ifdef __SSE2__
+uint64_t sampleEnergy(const int16_t* samples, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i total = zero;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        // Pairs of squares; at most 2 * 32768^2, which fits 32 bits unsigned,
+        // so zero-extend into the two 64-bit lanes instead of sign-extending.
+        __m128i squares = _mm_madd_epi16(v, v);
+        total = _mm_add_epi64(total, _mm_unpacklo_epi32(squares, zero));
+        total = _mm_add_epi64(total, _mm_unpackhi_epi32(squares, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+    return lanes[0] + lanes[1] + sampleEnergyScalar(samples + i, count - i);
+}
+#else
+uint64_t sampleEnergy(const int16_t* samples, size_t count) {
+    return sampleEnergyScalar(samples, count);
+}
+#endif
+
+size_t trimSilence(std::vector<uint8_t>& wav, const SilenceTrimOptions& options) {
+    PcmLayout layout;
+    if (!readPcm16(wav, layout)) return 0;
+
+    const int16_t* samples = reinterpret_cast<const int16_t*>(&wav[layout.dataOffset]);
+    size_t frames = layout.frames();
+    size_t windowFrames = std::max<size_t>(1, static_cast<size_t>(layout.sampleRate * options.windowMs / 1000.0));
+    size_t windows = (frames + windowFrames - 1) / windowFrames;
+    if (windows == 0) return 0;
+
+    // Compare mean squares without a sqrt: loud if energy > (threshold amplitude)^2 * samples.
+    double amplitude = 32768.0 * std::pow(10.0, options.thresholdDb / 20.0);
+    auto loud = [&](size_t window) {
+        size_t first = window * windowFrames;
+        size_t count = (std::min(frames, first + windowFrames) - first) * layout.channels;
+        return static_cast<double>(sampleEnergy(samples + first * layout.channels, count)) > amplitude * amplitude * count;
+    };
+
+    size_t firstLoud = 0;
+    while (firstLoud < windows && !loud(firstLoud)) ++firstLoud;
+    if (firstLoud == windows) return 0;  // all silence; leave it for the caller to notice
+    size_t lastLoud = windows - 1;
+    while (lastLoud > firstLoud && !loud(lastLoud)) --lastLoud;
+
+    size_t padding = static_cast<size_t>(layout.sampleRate * options.paddingMs / 1000.0);
+    size_t start = firstLoud * windowFrames;
+    size_t end = std::min(frames, (lastLoud + 1) * windowFrames);
+    start = start > padding ? start - padding : 0;
+    end = std::min(frames, end + padding);
+    if (start == 0 && end == frames) return 0;
+
+    size_t frameBytes = 2 * layout.channels;
+    size_t before = wav.size();
+    std::vector<uint8_t> trimmed(wav.begin(), wav.begin() + layout.dataOffset);
+    trimmed.insert(trimmed.end(), wav.begin() + layout.dataOffset + start * frameBytes,
+                   wav.begin() + layout.dataOffset + end * frameBytes);
+    write32(trimmed, layout.dataOffset - 4, static_cast<uint32_t>((end - start) * frameBytes));
+    write32(trimmed, 4, static_cast<uint32_t>(trimmed.size() - 8));
+    wav.swap(trimmed);
+    return before - wav.size();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Where speech is considered to start and end in a clip.
+ */
+struct SilenceTrimOptions {
+    double thresholdDb = -45.0;  /**< A window quieter than this (RMS, dBFS) is silence. */
+    double windowMs = 10.0;      /**< Energy is measured over windows this long. */
+    double paddingMs = 60.0;     /**< Kept on each side so onsets and decays are not clipped. */
+};
+
+/**
+ * @brief Cuts the leading and trailing silence out of a 16-bit PCM WAV.
+ *
+ * Energy is summed per window with SSE2 (pmaddwd) where available and with
+ * a scalar loop otherwise. The RIFF and data chunk sizes are rewritten; any
+ * chunk after the data chunk is dropped.
+ *
+ * @return The number of bytes removed; 0 if nothing was trimmed or the
+ *         audio is not 16-bit PCM, in which case it is left untouched.
+ */
+size_t trimSilence(std::vector<uint8_t>& wav, const SilenceTrimOptions& options = SilenceTrimOptions());
+
+/**
+ * @brief Sum of squares of the samples. Exposed so the SIMD and scalar
+ *        paths can be checked against each other.
+ */
+uint64_t sampleEnergy(const int16_t* samples, size_t count);
+uint64_t sampleEnergyScalar(const int16_t* samples, size_t count);
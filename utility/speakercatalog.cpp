@@ -0,0 +1,117 @@
+#include "speakercatalog.h"
+#include "tts.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <curl/curl.h>
+
+const char SpeakerCatalog::DEFAULT_FILE[] = "Persona.json";
+const char SpeakerCatalog::DEFAULT_STYLE[] = "Normal";
+
+// Loading a voice model takes seconds on CPU; give up on an engine that never answers.
+static const long WARM_UP_CONNECT_TIMEOUT_MS = 2000;
+static const long WARM_UP_TIMEOUT_MS = 60000;
+
+std::string SpeakerCatalog::key(const std::string& name, const std::string& style) {
+    std::string result = name + "/" + style;
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+        return std::tolower(c);
+    });
+    return result;
+}
+
+size_t SpeakerCatalog::load(const std::string& filename) {
+    byName_.clear();
+    byId_.clear();
+
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open speaker catalog: " << filename << std::endl;
+        return 0;
+    }
+
+    try {
+        json speakers;
+        file >> speakers;
+        for (const auto& speaker : speakers) {
+            std::string name = speaker["name"].get<std::string>();
+            for (const auto& style : speaker["styles"]) {
+                std::string styleName = style["name"].get<std::string>();
+                int id = style["id"].get<int>();
+                byName_[key(name, styleName)] = id;
+                byId_[id] = name + "/" + styleName;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to parse speaker catalog: " << e.what() << std::endl;
+        byName_.clear();
+        byId_.clear();
+    }
+    return byName_.size();
+}
+
+int SpeakerCatalog::id(const std::string& name, const std::string& style) const {
+    auto it = byName_.find(key(name, style));
+    return it == byName_.end() ? -1 : it->second;
+}
+
+int SpeakerCatalog::resolve(const std::string& spec) const {
+    if (!spec.empty() && std::all_of(spec.begin(), spec.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        // Digits only, but possibly more than an int holds.
+        errno = 0;
+        long value = std::strtol(spec.c_str(), nullptr, 10);
+        if (errno == ERANGE || value > INT_MAX) return -1;
+        return static_cast<int>(value);
+    }
+    // Split on the last '/', since names such as "Sayo/SAYO" contain one.
+    size_t slash = spec.rfind('/');
+    if (slash != std::string::npos) {
+        int styled = id(spec.substr(0, slash), spec.substr(slash + 1));
+        if (styled >= 0) return styled;
+    }
+    return id(spec);
+}
+
+std::string SpeakerCatalog::describe(int id) const {
+    auto it = byId_.find(id);
+    return it == byId_.end() ? "" : it->second;
+}
+
+std::future<size_t> warmUpSpeakers(const std::vector<int>& ids, const std::string& baseUrl) {
+    curlGlobalInit();
+    return std::async(std::launch::async, [ids, baseUrl]() {
+        CURL* curl = curl_easy_init();
+        if (!curl) return static_cast<size_t>(0);
+
+        std::string base = baseUrl;
+        if (!base.empty() && base.back() != '/') base += '/';
+
+        size_t ready = 0;
+        for (int id : ids) {
+            // skip_reinit: a voice that is already loaded returns at once.
+            std::string url = base + "initialize_speaker?speaker=" + std::to_string(id) + "&skip_reinit=true";
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, WARM_UP_CONNECT_TIMEOUT_MS);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, WARM_UP_TIMEOUT_MS);
+
+            long status = 0;
+            if (curl_easy_perform(curl) == CURLE_OK) {
+                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+            }
+            if (status == 200 || status == 204) {
+                ++ready;
+            } else {
+                std::cerr << "Failed to initialize speaker " << id << " (HTTP " << status << ")" << std::endl;
+            }
+        }
+        curl_easy_cleanup(curl);
+        return ready;
+    });
+}
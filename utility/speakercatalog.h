@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <future>
+
+/**
+ * @brief Index of the VOICEVOX voices listed in Persona.json (the engine's /speakers).
+ *
+ * Loaded once into a hash map keyed by "name/style", case-insensitive, so a
+ * voice can be picked by name instead of by a magic id:
+ *
+ *     catalog.id("Kyushu Sora", "Sexy")   // 17
+ *     catalog.resolve("Mochiko-san")      // 20, style defaults to Normal
+ *     catalog.resolve("13")               // 13, plain ids pass through
+ */
+class SpeakerCatalog {
+public:
+    static const char DEFAULT_FILE[];
+    static const char DEFAULT_STYLE[];
+
+    /** @return The number of styles indexed; 0 if the file is missing or invalid. */
+    size_t load(const std::string& filename = DEFAULT_FILE);
+
+    /** @return The style id, or -1 if the catalog has no such voice. */
+    int id(const std::string& name, const std::string& style = DEFAULT_STYLE) const;
+
+    /** @param spec "Name", "Name/Style" or a numeric id. @return The id, or -1 (also for an id out of range). */
+    int resolve(const std::string& spec) const;
+
+    /** @return "Name/Style" for an id, or an empty string. */
+    std::string describe(int id) const;
+
+    size_t size() const { return byName_.size(); }
+    bool empty() const { return byName_.empty(); }
+
+private:
+    static std::string key(const std::string& name, const std::string& style);
+
+    std::unordered_map<std::string, int> byName_;
+    std::unordered_map<int, std::string> byId_;
+};
+
+/**
+ * @brief Asks the engine to load the models of these voices in the background,
+ *        so the first synthesis with each does not pay the model-load time.
+ * @return Resolves to the number of voices the engine confirmed.
+ */
+std::future<size_t> warmUpSpeakers(const std::vector<int>& ids, const std::string& baseUrl);
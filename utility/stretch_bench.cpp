@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+///             Time-stretch benchmark
+///
+///
+/// Compares "replay at another speed" done locally with timeStretch against
+/// asking the engine to resynthesize with a different speedScale. For each
+/// speed it reports the cost of both, the length of both results, and the
+/// level of the stretched audio relative to the source.
+///
+/// Usage:   ./stretch_bench [clip.wav] [text] [iterations]
+///          VOICEVOX_URL=http://127.0.0.1:50123/ ./stretch_bench wav/how_are_you.wav "お元気ですか"
+///
+/// Without a reachable engine only the local side is measured.
+///
+/// @see     timestretch.h
+///
+/// @file    stretch_bench.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include "ttsclient.h"
+#include "timestretch.h"
+#include "wavpcm.h"
+
+static double seconds(const std::vector<uint8_t>& wav) {
+    PcmLayout layout;
+    return readPcm16(wav, layout) ? static_cast<double>(layout.frames()) / layout.sampleRate : 0.0;
+}
+
+static double rms(const std::vector<uint8_t>& wav) {
+    PcmLayout layout;
+    if (!readPcm16(wav, layout) || layout.dataBytes < 2) return 0.0;
+    const int16_t* samples = reinterpret_cast<const int16_t*>(&wav[layout.dataOffset]);
+    size_t count = layout.dataBytes / 2;
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) sum += static_cast<double>(samples[i]) * samples[i];
+    return std::sqrt(sum / count);
+}
+
+int main(int argc, char* argv[]) {
+    std::string clipFile = argc > 1 ? argv[1] : "wav/how_are_you.wav";
+    std::string text = argc > 2 ? argv[2] : "お元気ですか";
+    int iterations = argc > 3 ? std::stoi(argv[3]) : 20;
+    const double speeds[] = { 0.75, 0.85, 1.25, 1.5 };
+
+    std::ifstream file(clipFile, std::ios::binary);
+    std::vector<uint8_t> source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    PcmLayout layout;
+    if (!readPcm16(source, layout)) {
+        std::cerr << "Not a 16-bit PCM WAV: " << clipFile << std::endl;
+        return 1;
+    }
+    std::cout << clipFile << ": " << seconds(source) << " s, " << layout.sampleRate << " Hz, "
+              << layout.channels << " channel(s)" << std::endl;
+
+    VoiceClient voice(1);
+    bool engine = !voice.fetchEngineVersion().empty();
+    if (!engine) {
+        std::cout << "No engine at " << voice.baseUrl() << "; measuring the local stretch only." << std::endl;
+    }
+
+    StretchCache cache;
+    std::cout << std::fixed << std::setprecision(3);
+    for (double speed : speeds) {
+        std::vector<uint8_t> stretched;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) timeStretchWav(source, speed, stretched);
+        double localMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+        cache.get(source, speed);
+        start = std::chrono::steady_clock::now();
+        cache.get(source, speed);
+        double cachedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        double expected = seconds(source) / speed;
+        std::cout << "speed " << speed << ": local " << localMs << " ms (cached " << cachedMs << " ms), "
+                  << seconds(stretched) << " s (expected " << expected << "), level "
+                  << rms(stretched) / rms(source) << " of source";
+
+        if (engine) {
+            SynthesisParams params;
+            params.text = text;
+            params.speedScale = speed;
+            SynthesisResult result = voice.synthesize(params).get();
+            if (result.ok) {
+                std::cout << "; engine " << result.latencyMs << " ms, " << seconds(result.audio) << " s";
+            } else {
+                std::cout << "; engine failed: " << result.error;
+            }
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
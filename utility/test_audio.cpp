@@ -1,26 +1,79 @@
 #include <iostream>
-#include <chrono>
-#include <thread>
+#include <string>
+#include <future>
 #include "AudioPlayer.h"
+#include "AudioEngine.h"
+
+// ./test_audio --sequence hello how_are_you thank_you plays the clips back to back, with no gap
+static int playSequence(int count, char* clips[]) {
+    AudioPack pack;
+    if (!pack.open("../wav.pack")) {
+        std::cerr << "Failed to open ../wav.pack (build it with make wav-pack)." << std::endl;
+        return 1;
+    }
+    AudioEngine& engine = AudioEngine::instance();
+    engine.loadPack(pack);
+
+    std::promise<void> done;
+    for (int i = 0; i < count; ++i) {
+        AudioEngine::SoundId clip = engine.find(clips[i]);
+        if (clip == AudioEngine::INVALID_SOUND) {
+            std::cerr << "No clip named " << clips[i] << " in the pack." << std::endl;
+            return 1;
+        }
+        bool last = i + 1 == count;
+        engine.enqueue(clip, last ? AudioEngine::FinishedCallback([&done]() { done.set_value(); }) : nullptr);
+    }
+    // Everything is queued; the mixer plays it without this thread.
+    done.get_future().wait();
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && std::string(argv[1]) == "--sequence") {
+        return playSequence(argc - 2, argv + 2);
+    }
+
+    // ./test_audio <clip> <frames> opens the device in low-latency mode with that buffer
+    if (argc > 2) {
+        AudioEngine::instance().configure(AudioConfig::lowLatency(std::stoi(argv[2])));
+    }
 
-int main() {
     // Create an instance of AudioPlayer
     AudioPlayer audioPlayer;
 
+    // ./test_audio <clip> plays a prompt from the packed wav/ directory instead
+    if (argc > 1) {
+        AudioPack pack;
+        if (!pack.open("../wav.pack")) {
+            std::cerr << "Failed to open ../wav.pack (build it with make wav-pack)." << std::endl;
+            return 1;
+        }
+        AudioEngine& engine = AudioEngine::instance();
+        engine.loadPack(pack);
+        AudioEngine::SoundId clip = engine.find(argv[1]);
+        if (clip == AudioEngine::INVALID_SOUND) {
+            std::cerr << "No clip named " << argv[1] << " in the pack." << std::endl;
+            return 1;
+        }
+        // Returns as soon as the clip has played out
+        engine.playAsync(clip).wait();
+
+        AudioLatency latency = engine.latency();
+        const AudioConfig& config = engine.config();
+        std::cout << config.sampleRate << " Hz, " << config.channels << " channel(s), buffer "
+                  << latency.bufferMs << " ms; play to output " << latency.lastMs << " ms" << std::endl;
+        return 0;
+    }
+
     // Load the audio file
     if (!audioPlayer.loadAudio("../test_audio.wav")) {
         std::cerr << "Failed to load audio." << std::endl;
         return 1;
     }
 
-    // Play the audio
-    audioPlayer.play();
-
-    // Delay for a few seconds (adjust the duration as needed)
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-
-    // Stop the audio
-    audioPlayer.stop();
+    // Play the audio and wait until it ends
+    audioPlayer.playAsync().wait();
 
     return 0;
 }
@@ -1,60 +1,76 @@
 #include <iostream>
-#include <chrono>
-#include <thread>
-#include "tts.h"
+#include "ttsclient.h"
+#include "audiocache.h"
+#include "querycache.h"
+#include "speakercatalog.h"
 #include "AudioPlayer.h"
 
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <text>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <text> [more text ...]" << std::endl;
         return 1;
     }
 
-    //std::string text = "私の声はAIとChatGPTによって合成されています。";
-    std::string text = argv[1];
-
-    Voice voice;
-
-    std::map<std::string, std::string> params;
-    params["text"] = voice.urlEncode(text);
-    params["speaker"] = "17";
-    params["speedScale"] = "1.7";
-    params["volumeScale"] = "1.0";
-    params["intonationScale"] = "1.5";
-    params["prePhonemeLength"] = "1.0";
-    params["postPhonemeLength"] = "1.0";
+    // Persona.json lives in the repository root; make runs this from there.
+    SpeakerCatalog speakers;
+    speakers.load();
+    int speaker = speakers.resolve("Kyushu Sora/Sexy");
 
-    std::string url1 = voice.buildUrl("audio_query", params);
-    json response1 = voice.postRequest(url1, "");
+    //std::string text = "私の声はAIとChatGPTによって合成されています。";
+    AudioCache cache;  // caches are declared first so they outlive the client
+    QueryCache queries;
+    VoiceClient voice;
+    std::future<size_t> speakerReady;
+    if (speaker >= 0) {
+        speakerReady = warmUpSpeakers({ speaker }, voice.baseUrl());
+    }
+    std::string version = voice.fetchEngineVersion();
+    cache.setEngineVersion(version);
+    queries.setEngineVersion(version);
+    voice.setCache(&cache);
+    voice.setQueryCache(&queries);
 
-    if (response1.contains("error")) {
-        std::cerr << "Error in audio_query request: " << response1["error"] << std::endl;
-        return 1;
+    // Every argument is its own utterance; they are all in flight at once.
+    std::vector<std::future<SynthesisResult>> results;
+    for (int i = 1; i < argc; ++i) {
+        SynthesisParams params;
+        params.text = argv[i];
+        if (speaker >= 0) params.speaker = speaker;
+        params.speedScale = 1.7;
+        params.volumeScale = 1.0;
+        params.intonationScale = 1.5;
+        params.prePhonemeLength = 1.0;
+        params.postPhonemeLength = 1.0;
+        params.trimSilence = true;  // the 1 s pauses above are only wanted between clips
+        results.push_back(voice.synthesize(params));
     }
 
-    std::string url2 = voice.buildUrl("synthesis", params);
-    std::string audioFilePath = "test_audio.wav";
-    voice.postRequestWithJson(url2, response1, audioFilePath);
+    std::vector<uint8_t> firstAudio;
+    for (size_t i = 0; i < results.size(); ++i) {
+        SynthesisResult result = results[i].get();
+        if (!result.ok) {
+            std::cerr << "Synthesis failed for \"" << argv[i + 1] << "\": " << result.error << std::endl;
+            return 1;
+        }
+        std::cout << (result.cached ? "Cached \"" : "Synthesized \"") << argv[i + 1] << "\" in "
+                  << result.latencyMs << " ms (" << result.audio.size() << " bytes)" << std::endl;
 
-    std::cout << "Audio file saved: " << audioFilePath << std::endl;
+        if (i == 0) {
+            firstAudio = std::move(result.audio);
+        }
+    }
 
     // Create an instance of AudioPlayer
     AudioPlayer audioPlayer;
 
-    // Load the audio file
-    if (!audioPlayer.loadAudio("test_audio.wav")) {
+    // Load the first utterance straight from memory
+    if (!audioPlayer.loadAudio(firstAudio)) {
         std::cerr << "Failed to load audio." << std::endl;
         return 1;
     }
 
-    // Play the audio
-    audioPlayer.play();
-
-    // Delay for a few seconds (adjust the duration as needed)
-    std::this_thread::sleep_for(std::chrono::seconds(3));
-
-    // Stop the audio
-    audioPlayer.stop();
+    // Play the audio and wait until it ends
+    audioPlayer.playAsync().wait();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,162 @@
+#include "timestretch.h"
+#include "wavpcm.h"
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+
+const double FRAME_MS = 20.0;
+const double TOLERANCE_MS = 5.0;
+const long COARSE_STEP = 4;  // search every 4th offset, then refine around the best
+
+// How well the hop samples at candidate continue the ones at natural,
+// normalized so loud candidates are not favoured.
+double similarity(const std::vector<float>& guide, long natural, long candidate, size_t length) {
+    double dot = 0.0, energy = 1e-9;
+    for (size_t i = 0; i < length; ++i) {
+        float c = guide[candidate + i];
+        dot += guide[natural + i] * c;
+        energy += c * c;
+    }
+    return dot / std::sqrt(energy);
+}
+
+long bestOffset(const std::vector<float>& guide, long natural, long low, long high, size_t length) {
+    long best = low;
+    double bestScore = -1e300;
+    auto consider = [&](long candidate) {
+        double score = similarity(guide, natural, candidate, length);
+        if (score > bestScore) {
+            bestScore = score;
+            best = candidate;
+        }
+    };
+    for (long candidate = low; candidate <= high; candidate += COARSE_STEP) consider(candidate);
+    long coarse = best;
+    for (long candidate = std::max(low, coarse - COARSE_STEP + 1); candidate <= std::min(high, coarse + COARSE_STEP - 1); ++candidate) {
+        if (candidate != coarse) consider(candidate);
+    }
+    return best;
+}
+
+std::string contentHash(const std::vector<uint8_t>& data) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint8_t byte : data) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return ss.str();
+}
+
+}  // namespace
+
+std::vector<int16_t> timeStretch(const int16_t* samples, size_t frames, int channels, int sampleRate, double speed) {
+    if (frames == 0 || channels <= 0 || sampleRate <= 0 || speed <= 0.0) return std::vector<int16_t>();
+    if (std::fabs(speed - 1.0) < 1e-3) return std::vector<int16_t>(samples, samples + frames * channels);
+
+    size_t window = std::max<size_t>(16, static_cast<size_t>(sampleRate * FRAME_MS / 1000.0)) & ~static_cast<size_t>(1);
+    size_t hop = window / 2;  // a periodic Hann window at half overlap sums to one
+    long tolerance = static_cast<long>(sampleRate * TOLERANCE_MS / 1000.0);
+    size_t outFrames = static_cast<size_t>(std::llround(frames / speed));
+
+    std::vector<float> hann(window);
+    for (size_t i = 0; i < window; ++i) hann[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / window));
+
+    // The search runs on a mono mix; the frames it picks are copied for every channel.
+    std::vector<float> guide(frames);
+    for (size_t f = 0; f < frames; ++f) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) sum += samples[f * channels + c];
+        guide[f] = sum / channels;
+    }
+
+    std::vector<float> mixed((outFrames + window) * channels, 0.0f);
+    std::vector<float> weight(outFrames + window, 0.0f);
+    long last = static_cast<long>(frames) - static_cast<long>(hop);
+    long previous = 0;
+    for (size_t k = 0; k * hop < outFrames; ++k) {
+        long nominal = static_cast<long>(std::llround(k * hop * speed));
+        long position = std::min(nominal, static_cast<long>(frames) - 1);
+        long natural = previous + static_cast<long>(hop);
+        if (k > 0 && natural <= last) {
+            long low = std::max(0L, nominal - tolerance);
+            long high = std::min(last, nominal + tolerance);
+            if (low <= high) position = bestOffset(guide, natural, low, high, hop);
+        }
+
+        size_t out = k * hop;
+        for (size_t i = 0; i < window && position + static_cast<long>(i) < static_cast<long>(frames); ++i) {
+            const int16_t* in = samples + (position + i) * channels;
+            for (int c = 0; c < channels; ++c) mixed[(out + i) * channels + c] += in[c] * hann[i];
+            weight[out + i] += hann[i];
+        }
+        previous = position;
+    }
+
+    std::vector<int16_t> stretched(outFrames * channels);
+    for (size_t f = 0; f < outFrames; ++f) {
+        // Dividing by the summed window also fixes the fade at either end.
+        float gain = weight[f] > 1e-3f ? 1.0f / weight[f] : 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            float value = mixed[f * channels + c] * gain;
+            stretched[f * channels + c] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, std::round(value))));
+        }
+    }
+    return stretched;
+}
+
+bool timeStretchWav(const std::vector<uint8_t>& wav, double speed, std::vector<uint8_t>& stretched) {
+    PcmLayout layout;
+    if (!readPcm16(wav, layout)) return false;
+    const int16_t* samples = reinterpret_cast<const int16_t*>(&wav[layout.dataOffset]);
+    std::vector<int16_t> pcm = timeStretch(samples, layout.frames(), layout.channels, static_cast<int>(layout.sampleRate), speed);
+    stretched = makePcm16Wav(pcm.data(), pcm.size() / layout.channels, layout.sampleRate, layout.channels);
+    return true;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> StretchCache::get(const std::vector<uint8_t>& wav, double speed) {
+    std::stringstream ss;
+    ss << contentHash(wav) << "@" << std::fixed << std::setprecision(2) << speed;
+    std::string key = ss.str();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            ++hits_;
+            return it->second->second;
+        }
+    }
+    ++misses_;
+
+    // Stretched outside the lock; two callers racing on one variant both compute it.
+    std::shared_ptr<std::vector<uint8_t>> variant = std::make_shared<std::vector<uint8_t>>();
+    if (!timeStretchWav(wav, std::round(speed * 100.0) / 100.0, *variant)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.find(key) == entries_.end()) {
+        lru_.emplace_front(key, variant);
+        entries_[key] = lru_.begin();
+        totalBytes_ += variant->size();
+        while (totalBytes_ > maxBytes_ && lru_.size() > 1) {
+            totalBytes_ -= lru_.back().second->size();
+            entries_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+    }
+    return variant;
+}
+
+size_t StretchCache::entryCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+size_t StretchCache::totalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalBytes_;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Changes the tempo of 16-bit PCM without changing its pitch (WSOLA).
+ *
+ * The input is cut into 20 ms Hann-windowed frames that are overlap-added
+ * at a fixed 10 ms output hop. Each frame is read from near its nominal
+ * input position (output position * speed), shifted by up to ±5 ms to the
+ * offset whose waveform best continues the previous frame, which keeps
+ * the periods of voiced speech aligned and avoids phasing.
+ *
+ * @param speed Same sense as SynthesisParams::speedScale: 0.8 is slower, 1.25 faster.
+ * @return The stretched samples, interleaved like the input.
+ */
+std::vector<int16_t> timeStretch(const int16_t* samples, size_t frames, int channels, int sampleRate, double speed);
+
+/**
+ * @brief timeStretch on a whole WAV. @return False unless the input is 16-bit PCM.
+ */
+bool timeStretchWav(const std::vector<uint8_t>& wav, double speed, std::vector<uint8_t>& stretched);
+
+/**
+ * @brief In-memory LRU of stretched variants, so replaying a clip at a speed
+ *        heard before costs nothing.
+ *
+ * Variants are keyed by a hash of the source WAV and the speed rounded to
+ * 0.01; the same audio from the audio cache and from a fresh synthesis map
+ * to the same entry.
+ */
+class StretchCache {
+public:
+    static const size_t DEFAULT_MAX_BYTES = 32 * 1024 * 1024;
+
+    explicit StretchCache(size_t maxBytes = DEFAULT_MAX_BYTES) : maxBytes_(maxBytes) {}
+
+    /**
+     * @return The source stretched to speed, computed on a miss; nullptr if
+     *         the source is not 16-bit PCM.
+     */
+    std::shared_ptr<const std::vector<uint8_t>> get(const std::vector<uint8_t>& wav, double speed);
+
+    size_t entryCount() const;
+    size_t totalBytes() const;
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+private:
+    typedef std::pair<std::string, std::shared_ptr<const std::vector<uint8_t>>> Entry;
+
+    size_t maxBytes_;
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  /**< Most recently used first. */
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries_;
+    size_t totalBytes_ = 0;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
@@ -1,20 +1,47 @@
 #include "tts.h"
+#include "ttsclient.h"
+#include <cstdlib>
 #include <iostream>
-#include <fstream>
 #include <curl/curl.h>
 
-const std::string Voice::BASE_URL = "http://127.0.0.1:50021/"; // Change this in the future.
+namespace {
+struct CurlGlobal {
+    CurlGlobal() { curl_global_init(CURL_GLOBAL_DEFAULT); }
+    ~CurlGlobal() { curl_global_cleanup(); }
+};
+}
 
-Voice::Voice() {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+void curlGlobalInit() {
+    static CurlGlobal instance;  // thread-safe, runs exactly once
+    (void)instance;
+}
+
+std::string voicevoxBaseUrl() {
+    const char* url = std::getenv("VOICEVOX_URL");
+    return url && *url ? url : VoiceClient::DEFAULT_BASE_URL;
+}
+
+Voice::Voice(const std::string& baseUrl) : baseUrl_(baseUrl), jsonHeaders_(nullptr), wavHeaders_(nullptr) {
+    curlGlobalInit();
+    if (!baseUrl_.empty() && baseUrl_.back() != '/') baseUrl_ += '/';
     curl = curl_easy_init();
+
+    struct curl_slist* headers = NULL;
+    headers = curl_slist_append(headers, "Accept: application/json");
+    jsonHeaders_ = headers;
+
+    headers = NULL;
+    headers = curl_slist_append(headers, "Accept: audio/wav");
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    wavHeaders_ = headers;
 }
 
 Voice::~Voice() {
     if (curl) {
         curl_easy_cleanup(curl);
     }
-    curl_global_cleanup();
+    curl_slist_free_all(static_cast<struct curl_slist*>(jsonHeaders_));
+    curl_slist_free_all(static_cast<struct curl_slist*>(wavHeaders_));
 }
 
 /** To satisfy rule of 5 there's no resource management so we don't need this
@@ -58,11 +85,8 @@ std::string Voice::urlEncode(const std::string& value) {
 json Voice::postRequest(const std::string& url, const std::string& data) {
     std::string response;
     if (curl) {
-        struct curl_slist* headers = NULL;
-        headers = curl_slist_append(headers, "Accept: application/json");
-
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, jsonHeaders_);
         curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
 
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
@@ -73,45 +97,34 @@ json Voice::postRequest(const std::string& url, const std::string& data) {
             std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
             return { { "error", curl_easy_strerror(res) } };
         }
-
-        curl_slist_free_all(headers);
     }
 
     return json::parse(response);
 }
 
-void Voice::postRequestWithJson(const std::string& url, const json& data, const std::string& audioFilePath) {
-    std::ofstream outFile(audioFilePath, std::ios::binary);
-    if (!outFile.is_open()) {
-        std::cerr << "Failed to open output file: " << audioFilePath << std::endl;
-        return;
-    }
-
+std::vector<uint8_t> Voice::postRequestWithJson(const std::string& url, const json& data) {
+    std::vector<uint8_t> audio;
     if (curl) {
-        struct curl_slist* headers = NULL;
-        headers = curl_slist_append(headers, "Accept: audio/wav");
-        headers = curl_slist_append(headers, "Content-Type: application/json");
+        std::string body = data.dump();  // must outlive curl_easy_perform
 
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.dump().c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, wavHeaders_);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
 
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_data);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &outFile);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_audio);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &audio);
 
         CURLcode res = curl_easy_perform(curl);
         if (res != CURLE_OK) {
             std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
+            audio.clear();
         }
-
-        curl_slist_free_all(headers);
     }
-
-    outFile.close();
+    return audio;
 }
 
 std::string Voice::buildUrl(const std::string& endpoint, const std::map<std::string, std::string>& params) {
-    std::string url = BASE_URL + endpoint;
+    std::string url = baseUrl_ + endpoint;
     if (!params.empty()) {
         url += "?";
         for (const auto& param : params) {
@@ -128,8 +141,8 @@ size_t Voice::write_callback(void* contents, size_t size, size_t nmemb, std::str
     return newLength;
 }
 
-size_t Voice::write_data(void* ptr, size_t size, size_t nmemb, std::ofstream* outFile) {
-    if (!outFile->is_open()) return 0;  // Ensure the file is open
-    outFile->write(reinterpret_cast<char*>(ptr), size * nmemb);
+size_t Voice::write_audio(void* ptr, size_t size, size_t nmemb, std::vector<uint8_t>* audio) {
+    const uint8_t* data = static_cast<const uint8_t*>(ptr);
+    audio->insert(audio->end(), data, data + size * nmemb);
     return size * nmemb;
 }
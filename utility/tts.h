@@ -2,25 +2,42 @@
 
 #include <string>
 #include <map>
+#include <vector>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
+/**
+ * @brief Initializes libcurl once per process; cleanup runs at exit.
+ */
+void curlGlobalInit();
+
+/**
+ * @brief Engine base URL: $VOICEVOX_URL when set, otherwise VoiceClient::DEFAULT_BASE_URL.
+ */
+std::string voicevoxBaseUrl();
+
 class Voice {
 public:
-    Voice();
+    explicit Voice(const std::string& baseUrl = voicevoxBaseUrl());
     ~Voice();
 
     std::string urlEncode(const std::string& value);
     json postRequest(const std::string& url, const std::string& data);
-    void postRequestWithJson(const std::string& url, const json& data, const std::string& audioFilePath);
+    /**
+     * @brief POSTs an audio_query body to /synthesis.
+     * @return The WAV bytes, captured in memory; empty on failure.
+     */
+    std::vector<uint8_t> postRequestWithJson(const std::string& url, const json& data);
     std::string buildUrl(const std::string& endpoint, const std::map<std::string, std::string>& params);
 
 private:
-    static const std::string BASE_URL;
-
+    std::string baseUrl_;
     void* curl;
+    void* jsonHeaders_; /**< Built once; reused by every audio_query request. */
+    void* wavHeaders_;  /**< Built once; reused by every synthesis request. */
 
     static size_t write_callback(void* contents, size_t size, size_t nmemb, std::string* s);
-    static size_t write_data(void* ptr, size_t size, size_t nmemb, std::ofstream* outFile);
+    static size_t write_audio(void* ptr, size_t size, size_t nmemb, std::vector<uint8_t>* audio);
 };
\ No newline at end of file
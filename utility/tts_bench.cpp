@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+///             TTS client benchmark
+///
+///
+/// Drives VoiceClient with a fixed number of requests in flight and reports
+/// throughput and latency percentiles. Every request uses a distinct text
+/// and no cache, so each one costs an audio_query and a synthesis.
+///
+/// Usage:   ./tts_bench [requests] [concurrency]
+///          VOICEVOX_URL=http://127.0.0.1:50123/ ./tts_bench 500 8
+///
+/// @see     mock_voicevox.cpp
+///
+/// @file    tts_bench.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include "ttsclient.h"
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+int main(int argc, char* argv[]) {
+    size_t requests = argc > 1 ? std::stoul(argv[1]) : 200;
+    size_t concurrency = argc > 2 ? std::stoul(argv[2]) : 4;
+
+    VoiceClient voice(concurrency);
+    if (voice.fetchEngineVersion().empty()) {
+        std::cerr << "VOICEVOX engine is not reachable at " << voice.baseUrl() << std::endl;
+        return 1;
+    }
+
+    std::mutex mutex;
+    std::condition_variable slotFreed;
+    size_t inFlight = 0, failed = 0;
+    uint64_t audioBytes = 0;
+    std::vector<double> latencies;
+    latencies.reserve(requests);
+
+    // Closed loop: a new request starts only when one finishes, so the
+    // measured latency is service time, not time spent in the client queue.
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < requests; ++i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFreed.wait(lock, [&] { return inFlight < concurrency; });
+            ++inFlight;
+        }
+        SynthesisParams params;
+        params.text = "ベンチマーク" + std::to_string(i);
+        voice.synthesize(params, [&](const SynthesisResult& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (result.ok) {
+                latencies.push_back(result.latencyMs);
+                audioBytes += result.audio.size();
+            } else {
+                ++failed;
+            }
+            --inFlight;
+            slotFreed.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFreed.wait(lock, [&] { return inFlight == 0; });
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::fixed << std::setprecision(1)
+              << requests << " requests, concurrency " << concurrency << ", " << failed << " failed, "
+              << seconds << " s, " << (seconds > 0 ? latencies.size() / seconds : 0) << " utterances/s, "
+              << (seconds > 0 ? audioBytes / 1024.0 / 1024.0 / seconds : 0) << " MiB/s" << std::endl;
+    std::cout << "Latency ms: p50 " << percentile(latencies, 0.50) << ", p95 " << percentile(latencies, 0.95)
+              << ", p99 " << percentile(latencies, 0.99) << ", max " << (latencies.empty() ? 0.0 : latencies.back())
+              << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+///             TTS cache warm-up
+///
+///
+/// Synthesizes every item of a deck into the audio cache so the quiz never
+/// waits on VOICEVOX for a word it has already heard.
+///
+/// Usage:   ./tts_warmup <deck.json> [concurrency] [cache_dir]
+///
+/// @see     audiocache.h
+///
+/// @file    tts_warmup.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <set>
+#include "ttsclient.h"
+#include "audiocache.h"
+#include "querycache.h"
+
+// Accepts both deck layouts in the repo: quiz_data.json and japanese_101.json.
+static std::vector<std::string> loadDeckTexts(const std::string& filename) {
+    std::vector<std::string> texts;
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open deck: " << filename << std::endl;
+        return texts;
+    }
+
+    json deck;
+    try {
+        file >> deck;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to parse deck: " << e.what() << std::endl;
+        return texts;
+    }
+
+    const json& items = deck.is_array() ? deck : deck["vocabulary"];
+    std::set<std::string> seen;
+    for (const auto& item : items) {
+        std::string text;
+        if (item.contains("kanji")) text = item["kanji"].get<std::string>();
+        else if (item.contains("word")) text = item["word"].get<std::string>();
+        if (!text.empty() && seen.insert(text).second) texts.push_back(text);
+    }
+    return texts;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <deck.json> [concurrency] [cache_dir]" << std::endl;
+        return 1;
+    }
+
+    size_t concurrency = argc > 2 ? std::stoul(argv[2]) : 4;
+    std::string cacheDir = argc > 3 ? argv[3] : AudioCache::DEFAULT_DIR;
+
+    std::vector<std::string> texts = loadDeckTexts(argv[1]);
+    if (texts.empty()) return 1;
+
+    AudioCache cache(cacheDir);  // caches are declared first so they outlive the client
+    QueryCache queries(cacheDir + "/queries");
+    VoiceClient voice(concurrency);
+    std::string version = voice.fetchEngineVersion();
+    if (version.empty()) {
+        std::cerr << "VOICEVOX engine is not reachable at " << voice.baseUrl() << std::endl;
+        return 1;
+    }
+    cache.setEngineVersion(version);
+    queries.setEngineVersion(version);
+    voice.setCache(&cache);
+    voice.setQueryCache(&queries);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<SynthesisResult>> results;
+    for (const auto& text : texts) {
+        SynthesisParams params;
+        params.text = text;
+        results.push_back(voice.synthesize(params));
+    }
+
+    size_t cached = 0, synthesized = 0, failed = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        SynthesisResult result = results[i].get();
+        if (!result.ok) {
+            std::cerr << "Failed: " << texts[i] << " (" << result.error << ")" << std::endl;
+            ++failed;
+        } else if (result.cached) {
+            ++cached;
+        } else {
+            ++synthesized;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Warm-up done in " << seconds << " s: " << synthesized << " synthesized, "
+              << cached << " already cached, " << failed << " failed. Cache: "
+              << cache.entryCount() << " entries, " << cache.totalBytes() / 1024 << " KiB" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,354 @@
+#include "ttsclient.h"
+#include "tts.h"
+#include "audiocache.h"
+#include "querycache.h"
+#include "silencetrim.h"
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <curl/curl.h>
+
+const char VoiceClient::DEFAULT_BASE_URL[] = "http://127.0.0.1:50021/";
+const long VoiceClient::DEFAULT_CONNECT_TIMEOUT_MS;
+const long VoiceClient::DEFAULT_REQUEST_TIMEOUT_MS;
+
+struct VoiceClient::Job {
+    enum class Stage { Query, Synthesis };
+
+    Stage stage = Stage::Query;
+    SynthesisParams params;
+    Callback callback;
+    std::promise<SynthesisResult> promise;
+    SynthesisResult result;
+    std::string url;
+    std::string body;      /**< POST body; must stay alive while the transfer runs. */
+    bool queryCached = false;  /**< body already holds a cached audio_query. */
+    std::string response;  /**< audio_query JSON. */
+    CURL* easy = nullptr;
+    std::chrono::steady_clock::time_point submitted;
+};
+
+VoiceClient::VoiceClient(size_t maxInFlight, const std::string& baseUrl)
+    : baseUrl_(baseUrl),
+      maxInFlight_(std::max<size_t>(1, maxInFlight)),
+      multi_(nullptr),
+      jsonHeaders_(nullptr),
+      wavHeaders_(nullptr),
+      active_(0),
+      stop_(false)
+{
+    curlGlobalInit();
+    if (!baseUrl_.empty() && baseUrl_.back() != '/') baseUrl_ += '/';
+
+    CURLM* multi = curl_multi_init();
+    // Keep one warm connection per concurrent transfer to the engine.
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(maxInFlight_));
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(maxInFlight_));
+    multi_ = multi;
+
+    struct curl_slist* headers = NULL;
+    headers = curl_slist_append(headers, "Accept: application/json");
+    jsonHeaders_ = headers;
+
+    headers = NULL;
+    headers = curl_slist_append(headers, "Accept: audio/wav");
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    wavHeaders_ = headers;
+
+    worker_ = std::thread(&VoiceClient::run, this);
+}
+
+VoiceClient::~VoiceClient() {
+    stop_ = true;
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    for (void* handle : idleHandles_) {
+        curl_easy_cleanup(static_cast<CURL*>(handle));
+    }
+    curl_multi_cleanup(static_cast<CURLM*>(multi_));
+    curl_slist_free_all(static_cast<struct curl_slist*>(jsonHeaders_));
+    curl_slist_free_all(static_cast<struct curl_slist*>(wavHeaders_));
+}
+
+std::future<SynthesisResult> VoiceClient::synthesize(const SynthesisParams& params, Callback callback) {
+    std::unique_ptr<Job> job(new Job());
+    job->params = params;
+    job->callback = std::move(callback);
+    job->submitted = std::chrono::steady_clock::now();
+
+    if (cache_ && cache_->get(params, job->result.audio)) {
+        // Cache hit: both HTTP requests are skipped; the worker only runs the
+        // callback, so it is on the same thread as for every other result.
+        job->result.ok = true;
+        job->result.cached = true;
+        std::future<SynthesisResult> future = job->promise.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(std::move(job));
+        }
+        curl_multi_wakeup(static_cast<CURLM*>(multi_));
+        return future;
+    }
+
+    // A known text/speaker pair only needs /synthesis with the new overrides.
+    json query;
+    if (queryCache_ && queryCache_->get(params.text, params.speaker, query)) {
+        applyOverrides(query, params);
+        job->body = query.dump();
+        job->queryCached = true;
+    }
+    std::future<SynthesisResult> future = job->promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    return future;
+}
+
+size_t VoiceClient::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size() + ready_.size() + active_;
+}
+
+std::string VoiceClient::escape(void* easy, const std::string& value) {
+    char* encoded = curl_easy_escape(static_cast<CURL*>(easy), value.c_str(), static_cast<int>(value.length()));
+    std::string result;
+    if (encoded) {
+        result = encoded;
+        curl_free(encoded);
+    }
+    return result;
+}
+
+void VoiceClient::applyOverrides(json& query, const SynthesisParams& params) {
+    query["speedScale"] = params.speedScale;
+    query["volumeScale"] = params.volumeScale;
+    query["intonationScale"] = params.intonationScale;
+    query["prePhonemeLength"] = params.prePhonemeLength;
+    query["postPhonemeLength"] = params.postPhonemeLength;
+}
+
+size_t VoiceClient::writeBody(void* contents, size_t size, size_t nmemb, Job* job) {
+    size_t length = size * nmemb;
+    const char* data = static_cast<const char*>(contents);
+    if (job->stage == Job::Stage::Query) {
+        job->response.append(data, length);
+    } else {
+        job->result.audio.insert(job->result.audio.end(), data, data + length);
+    }
+    return length;
+}
+
+std::string VoiceClient::fetchEngineVersion() {
+    CURL* easy = curl_easy_init();
+    if (!easy) return "";
+
+    std::string url = baseUrl_ + "version";
+    std::string response;
+    curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, 2000L);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION,
+                     static_cast<size_t (*)(void*, size_t, size_t, std::string*)>(
+                         [](void* contents, size_t size, size_t nmemb, std::string* s) {
+                             s->append(static_cast<char*>(contents), size * nmemb);
+                             return size * nmemb;
+                         }));
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &response);
+
+    CURLcode res = curl_easy_perform(easy);
+    long status = 0;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_cleanup(easy);
+    if (res != CURLE_OK || status != 200) return "";
+
+    // The engine answers with a JSON string such as "0.14.3".
+    try {
+        json version = json::parse(response);
+        if (version.is_string()) return version.get<std::string>();
+    } catch (const std::exception&) {
+    }
+    return response;
+}
+
+void* VoiceClient::acquireHandle() {
+    if (!idleHandles_.empty()) {
+        void* handle = idleHandles_.back();
+        idleHandles_.pop_back();
+        return handle;
+    }
+    return curl_easy_init();
+}
+
+void VoiceClient::bindHandle(Job& job) {
+    // Pooled handles still point at their previous job; rebind them.
+    CURL* easy = job.easy;
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeBody);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &job);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, &job);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    // A stalled engine fails the job instead of leaving its future pending.
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, connectTimeoutMs_);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, requestTimeoutMs_);
+}
+
+void VoiceClient::startQuery(Job& job) {
+    job.stage = Job::Stage::Query;
+    job.url = baseUrl_ + "audio_query?text=" + escape(job.easy, job.params.text) +
+              "&speaker=" + std::to_string(job.params.speaker);
+    job.body.clear();
+
+    CURL* easy = job.easy;
+    curl_easy_setopt(easy, CURLOPT_URL, job.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, jsonHeaders_);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, job.body.c_str());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, 0L);
+    curl_multi_add_handle(static_cast<CURLM*>(multi_), easy);
+}
+
+void VoiceClient::startSynthesis(Job& job) {
+    job.stage = Job::Stage::Synthesis;
+    job.url = baseUrl_ + "synthesis?speaker=" + std::to_string(job.params.speaker);
+
+    CURL* easy = job.easy;
+    curl_easy_setopt(easy, CURLOPT_URL, job.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, wavHeaders_);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, job.body.c_str());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(job.body.size()));
+    curl_multi_add_handle(static_cast<CURLM*>(multi_), easy);
+}
+
+void VoiceClient::startJobs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!queue_.empty() && inFlight_.size() < maxInFlight_) {
+        std::unique_ptr<Job> job = std::move(queue_.front());
+        queue_.pop_front();
+        job->easy = static_cast<CURL*>(acquireHandle());
+        bindHandle(*job);
+        if (job->queryCached) {
+            startSynthesis(*job);
+        } else {
+            startQuery(*job);
+        }
+        inFlight_.push_back(std::move(job));
+        ++active_;
+    }
+}
+
+void VoiceClient::finish(Job& job, bool ok, const std::string& error) {
+    if (ok && job.params.trimSilence) trimSilence(job.result.audio);
+    job.result.ok = ok;
+    job.result.error = error;
+    job.result.latencyMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - job.submitted).count();
+    if (!ok) job.result.audio.clear();
+    if (ok && cache_) cache_->put(job.params, job.result.audio);
+
+    deliver(job);
+
+    idleHandles_.push_back(job.easy);
+    auto it = std::find_if(inFlight_.begin(), inFlight_.end(),
+                           [&](const std::unique_ptr<Job>& entry) { return entry.get() == &job; });
+    if (it != inFlight_.end()) {
+        inFlight_.erase(it);
+        --active_;
+    }
+}
+
+void VoiceClient::deliver(Job& job) {
+    if (job.callback) {
+        try {
+            job.callback(job.result);
+        } catch (const std::exception& e) {
+            std::cerr << "TTS callback failed: " << e.what() << std::endl;
+        }
+    }
+    job.promise.set_value(std::move(job.result));
+}
+
+void VoiceClient::run() {
+    CURLM* multi = static_cast<CURLM*>(multi_);
+
+    while (!stop_) {
+        std::deque<std::unique_ptr<Job>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready.swap(ready_);
+        }
+        for (auto& job : ready) {
+            deliver(*job);
+        }
+        startJobs();
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        int left = 0;
+        bool progressed = false;
+        CURLMsg* msg = nullptr;
+        while ((msg = curl_multi_info_read(multi, &left))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            progressed = true;
+
+            CURL* easy = msg->easy_handle;
+            CURLcode code = msg->data.result;
+            Job* job = nullptr;
+            long status = 0;
+            curl_easy_getinfo(easy, CURLINFO_PRIVATE, reinterpret_cast<char**>(&job));
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+            curl_multi_remove_handle(multi, easy);
+
+            if (code != CURLE_OK) {
+                finish(*job, false, curl_easy_strerror(code));
+            } else if (status != 200) {
+                std::string stage = job->stage == Job::Stage::Query ? "audio_query" : "synthesis";
+                finish(*job, false, stage + " returned HTTP " + std::to_string(status));
+            } else if (job->stage == Job::Stage::Query) {
+                try {
+                    json query = json::parse(job->response);
+                    if (queryCache_) queryCache_->put(job->params.text, job->params.speaker, query);
+                    applyOverrides(query, job->params);
+                    job->body = query.dump();
+                    job->response.clear();
+                    startSynthesis(*job);
+                } catch (const std::exception& e) {
+                    finish(*job, false, std::string("Invalid audio_query response: ") + e.what());
+                }
+            } else {
+                finish(*job, true, "");
+            }
+        }
+
+        // A finished stage may have freed a slot or added a handle; drive it right away.
+        if (!progressed) {
+            curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+        }
+    }
+
+    // Shutting down: fail whatever is left so no caller waits forever.
+    while (!inFlight_.empty()) {
+        curl_multi_remove_handle(multi, inFlight_.back()->easy);
+        finish(*inFlight_.back(), false, "TTS client shut down");
+    }
+    std::deque<std::unique_ptr<Job>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready.swap(ready_);
+    }
+    for (auto& job : ready) {
+        deliver(*job);  // the audio is there; hand it over
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& job : queue_) {
+        job->result.error = "TTS client shut down";
+        job->promise.set_value(std::move(job->result));
+    }
+    queue_.clear();
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <future>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+#include "tts.h"
+
+class AudioCache;
+class QueryCache;
+
+/**
+ * @brief Everything VOICEVOX needs to turn a piece of text into audio.
+ */
+struct SynthesisParams {
+    std::string text;
+    int speaker = 17;  /**< Kyushu Sora (Sexy); see SpeakerCatalog for lookups by name. */
+    double speedScale = 1.0;
+    double volumeScale = 1.0;
+    double intonationScale = 1.0;
+    double prePhonemeLength = 0.1;
+    double postPhonemeLength = 0.1;
+    bool trimSilence = false;  /**< Cut leading/trailing silence before caching (silencetrim.h). */
+};
+
+/**
+ * @brief Outcome of one synthesis; audio holds the WAV bytes on success.
+ */
+struct SynthesisResult {
+    bool ok = false;
+    std::string error;
+    std::vector<uint8_t> audio;
+    double latencyMs = 0.0; /**< Submit to completion. */
+    bool cached = false;    /**< Served from the audio cache, no HTTP round trip. */
+};
+
+/**
+ * @brief Asynchronous VOICEVOX client built on the curl multi interface.
+ *
+ * One worker thread drives every transfer, so connections to the engine
+ * stay alive in the multi handle's connection cache and are reused across
+ * audio_query and synthesis calls. At most maxInFlight utterances are
+ * being synthesized at once; the rest wait in a FIFO queue.
+ */
+class VoiceClient {
+public:
+    typedef std::function<void(const SynthesisResult&)> Callback;
+
+    static const char DEFAULT_BASE_URL[];
+    static const long DEFAULT_CONNECT_TIMEOUT_MS = 2000;
+    static const long DEFAULT_REQUEST_TIMEOUT_MS = 30000;  /**< Per HTTP request; long texts synthesize slowly on CPU. */
+
+    explicit VoiceClient(size_t maxInFlight = 4, const std::string& baseUrl = voicevoxBaseUrl());
+    ~VoiceClient();
+
+    VoiceClient(const VoiceClient&) = delete;
+    VoiceClient& operator=(const VoiceClient&) = delete;
+
+    /**
+     * @brief Queues an utterance. The callback (if any) runs on the worker
+     *        thread before the future becomes ready, cache hits included.
+     *        A request the engine does not answer within the timeouts fails.
+     */
+    std::future<SynthesisResult> synthesize(const SynthesisParams& params, Callback callback = nullptr);
+
+    size_t pending() const;
+
+    /** @brief Limits for each HTTP request; set before the first synthesize(). */
+    void setTimeouts(long connectMs, long requestMs) {
+        connectTimeoutMs_ = connectMs;
+        requestTimeoutMs_ = requestMs;
+    }
+    const std::string& baseUrl() const { return baseUrl_; }
+
+    /**
+     * @brief Serves repeated utterances from disk and stores new ones.
+     *        The cache must outlive the client.
+     */
+    void setCache(AudioCache* cache) { cache_ = cache; }
+
+    /**
+     * @brief Reuses audio_query responses across calls that differ only in
+     *        speed/volume/intonation/phoneme lengths; a hit skips straight to
+     *        /synthesis. The cache must outlive the client.
+     */
+    void setQueryCache(QueryCache* queryCache) { queryCache_ = queryCache; }
+
+    /**
+     * @brief Blocking GET /version; part of the audio cache key.
+     * @return The engine version, or an empty string if the engine is unreachable.
+     */
+    std::string fetchEngineVersion();
+
+    /**
+     * @brief Copies the speed/intonation/... overrides into an audio_query body.
+     *        VOICEVOX reads them from the body, not from the synthesis URL.
+     */
+    static void applyOverrides(json& query, const SynthesisParams& params);
+
+private:
+    struct Job;
+
+    void run();
+    void startJobs();
+    void bindHandle(Job& job);
+    void startQuery(Job& job);
+    void startSynthesis(Job& job);
+    void finish(Job& job, bool ok, const std::string& error);
+    void deliver(Job& job);
+    void* acquireHandle();
+    static std::string escape(void* easy, const std::string& value);
+    static size_t writeBody(void* contents, size_t size, size_t nmemb, Job* job);
+
+    std::string baseUrl_;
+    size_t maxInFlight_;
+    long connectTimeoutMs_ = DEFAULT_CONNECT_TIMEOUT_MS;
+    long requestTimeoutMs_ = DEFAULT_REQUEST_TIMEOUT_MS;
+    AudioCache* cache_ = nullptr;
+    QueryCache* queryCache_ = nullptr;
+
+    void* multi_;
+    void* jsonHeaders_;
+    void* wavHeaders_;
+    std::vector<void*> idleHandles_;
+
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<Job>> queue_;
+    std::deque<std::unique_ptr<Job>> ready_;      /**< Cache hits waiting for their callback. */
+    std::vector<std::unique_ptr<Job>> inFlight_;  /**< Worker thread only. */
+    std::atomic<size_t> active_;
+    std::atomic<bool> stop_;
+    std::thread worker_;
+};
@@ -0,0 +1,112 @@
+#include "ttsprefetch.h"
+#include "audiocache.h"
+#include <algorithm>
+#include <memory>
+
+TtsPrefetcher::TtsPrefetcher(VoiceClient& client, AudioCache& cache, size_t queueCapacity, size_t maxOutstanding)
+    : client_(client),
+      cache_(cache),
+      capacity_(std::max<size_t>(1, queueCapacity)),
+      maxOutstanding_(std::max<size_t>(1, maxOutstanding)),
+      state_(std::make_shared<State>())
+{
+    worker_ = std::thread(&TtsPrefetcher::run, this);
+}
+
+TtsPrefetcher::~TtsPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->stop = true;
+        stale_ += state_->queue.size();
+        state_->queue.clear();
+    }
+    state_->wake.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    // Submitted prefetches hold their own reference to the state; nothing to wait for.
+}
+
+void TtsPrefetcher::schedule(const std::vector<SynthesisParams>& upcoming) {
+    std::deque<Item> next;
+    for (const auto& params : upcoming) {
+        if (next.size() >= capacity_) break;
+
+        Item item;
+        item.params = params;
+        item.key = cache_.canonicalKey(params);
+        bool duplicate = std::any_of(next.begin(), next.end(),
+                                     [&](const Item& queued) { return queued.key == item.key; });
+        if (!duplicate) next.push_back(std::move(item));
+    }
+
+    State& state = *state_;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    next.erase(std::remove_if(next.begin(), next.end(),
+                              [&](const Item& item) { return state.inFlight.count(item.key) > 0; }),
+               next.end());
+    for (const auto& queued : state.queue) {
+        bool kept = std::any_of(next.begin(), next.end(),
+                                [&](const Item& item) { return item.key == queued.key; });
+        if (!kept) ++stale_;
+    }
+    state.queue.swap(next);
+    state.wake.notify_all();
+}
+
+std::shared_future<SynthesisResult> TtsPrefetcher::fetch(const SynthesisParams& params) {
+    std::string key = cache_.canonicalKey(params);
+    {
+        State& state = *state_;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.inFlight.find(key);
+        if (it != state.inFlight.end()) {
+            ++joined_;
+            return it->second;
+        }
+        // Played now, so it no longer needs a background slot.
+        state.queue.erase(std::remove_if(state.queue.begin(), state.queue.end(),
+                                         [&](const Item& item) { return item.key == key; }),
+                          state.queue.end());
+    }
+    return client_.synthesize(params).share();
+}
+
+void TtsPrefetcher::complete(State& state, const std::string& key) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.inFlight.erase(key);
+    --state.outstanding;
+    state.wake.notify_all();
+}
+
+void TtsPrefetcher::run() {
+    State& state = *state_;
+    while (true) {
+        Item item;
+        std::shared_ptr<std::promise<SynthesisResult>> promise;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.wake.wait(lock, [&] {
+                return state.stop || (!state.queue.empty() && state.outstanding < maxOutstanding_);
+            });
+            if (state.stop) break;
+
+            item = std::move(state.queue.front());
+            state.queue.pop_front();
+            if (cache_.contains(item.params)) continue;
+
+            // Registered before submission so fetch() can join it right away.
+            promise = std::make_shared<std::promise<SynthesisResult>>();
+            state.inFlight[item.key] = promise->get_future().share();
+            ++state.outstanding;
+        }
+
+        ++prefetched_;
+        std::string key = item.key;
+        std::shared_ptr<State> shared = state_;
+        client_.synthesize(item.params, [shared, key, promise](const SynthesisResult& result) {
+            promise->set_value(result);
+            complete(*shared, key);
+        });
+    }
+}
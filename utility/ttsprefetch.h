@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "ttsclient.h"
+
+class AudioCache;
+
+/**
+ * @brief Synthesizes the audio of upcoming quiz questions ahead of time.
+ *
+ * The quiz hands over the next few utterances with schedule() every time it
+ * draws a question. A background worker takes them from a bounded queue and
+ * submits the ones that are not cached yet to the VoiceClient, keeping at
+ * most maxOutstanding of them in flight so a foreground request never waits
+ * behind a long prefetch backlog.
+ *
+ * Every schedule() replaces the queue: items that fell out of the lookahead
+ * window (the learner skipped ahead, the quiz type changed) are dropped
+ * before they reach the engine. fetch() joins a prefetch that is still
+ * running instead of synthesizing the same utterance twice.
+ *
+ * Destroying the prefetcher drops the queue and does not wait for
+ * prefetches already submitted: they finish (or time out) in the client,
+ * and anyone who joined one through fetch() still gets its result.
+ */
+class TtsPrefetcher {
+public:
+    static const size_t DEFAULT_QUEUE_CAPACITY = 8;
+    static const size_t DEFAULT_MAX_OUTSTANDING = 2;
+
+    /** The client and the cache must outlive the prefetcher. */
+    TtsPrefetcher(VoiceClient& client, AudioCache& cache,
+                  size_t queueCapacity = DEFAULT_QUEUE_CAPACITY,
+                  size_t maxOutstanding = DEFAULT_MAX_OUTSTANDING);
+    ~TtsPrefetcher();
+
+    TtsPrefetcher(const TtsPrefetcher&) = delete;
+    TtsPrefetcher& operator=(const TtsPrefetcher&) = delete;
+
+    /**
+     * @brief Replaces the lookahead window, soonest first. Returns immediately.
+     */
+    void schedule(const std::vector<SynthesisParams>& upcoming);
+
+    /**
+     * @brief Audio for an utterance that is about to play: served from the
+     *        cache, joined from a running prefetch, or synthesized now.
+     */
+    std::shared_future<SynthesisResult> fetch(const SynthesisParams& params);
+
+    uint64_t prefetched() const { return prefetched_; }  /**< Submitted to the engine. */
+    uint64_t stale() const { return stale_; }            /**< Dropped before submission. */
+    uint64_t joined() const { return joined_; }          /**< fetch() calls that reused a prefetch. */
+
+private:
+    struct Item {
+        SynthesisParams params;
+        std::string key;  /**< AudioCache canonical key. */
+    };
+
+    /** What the client's callbacks touch; it outlives the prefetcher if they do. */
+    struct State {
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Item> queue;
+        std::unordered_map<std::string, std::shared_future<SynthesisResult>> inFlight;
+        size_t outstanding = 0;
+        bool stop = false;
+    };
+
+    void run();
+    static void complete(State& state, const std::string& key);
+
+    VoiceClient& client_;
+    AudioCache& cache_;
+    size_t capacity_;
+    size_t maxOutstanding_;
+    std::shared_ptr<State> state_;
+
+    std::atomic<uint64_t> prefetched_{0};
+    std::atomic<uint64_t> stale_{0};
+    std::atomic<uint64_t> joined_{0};
+    std::thread worker_;
+};
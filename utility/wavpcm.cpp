@@ -0,0 +1,65 @@
+#include "wavpcm.h"
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+uint32_t read32(const std::vector<uint8_t>& data, size_t at) {
+    return static_cast<uint32_t>(data[at]) | static_cast<uint32_t>(data[at + 1]) << 8 |
+           static_cast<uint32_t>(data[at + 2]) << 16 | static_cast<uint32_t>(data[at + 3]) << 24;
+}
+
+uint16_t read16(const std::vector<uint8_t>& data, size_t at) {
+    return static_cast<uint16_t>(data[at] | data[at + 1] << 8);
+}
+
+void write32(std::vector<uint8_t>& data, size_t at, uint32_t value) {
+    for (int i = 0; i < 4; ++i) data[at + i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void write16(std::vector<uint8_t>& data, size_t at, uint16_t value) {
+    data[at] = static_cast<uint8_t>(value);
+    data[at + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+}  // namespace
+
+bool readPcm16(const std::vector<uint8_t>& wav, PcmLayout& layout) {
+    if (wav.size() < 12 || std::memcmp(&wav[0], "RIFF", 4) != 0 || std::memcmp(&wav[8], "WAVE", 4) != 0) return false;
+    bool haveFormat = false;
+    size_t at = 12;
+    while (at + 8 <= wav.size()) {
+        uint32_t chunkBytes = read32(wav, at + 4);
+        if (std::memcmp(&wav[at], "fmt ", 4) == 0 && chunkBytes >= 16 && at + 24 <= wav.size()) {
+            if (read16(wav, at + 8) != 1 || read16(wav, at + 22) != 16) return false;
+            layout.channels = read16(wav, at + 10);
+            layout.sampleRate = read32(wav, at + 12);
+            haveFormat = layout.channels > 0 && layout.sampleRate > 0;
+        } else if (std::memcmp(&wav[at], "data", 4) == 0) {
+            layout.dataOffset = at + 8;
+            layout.dataBytes = std::min<size_t>(chunkBytes, wav.size() - layout.dataOffset);
+            return haveFormat && layout.dataOffset % 2 == 0;
+        }
+        at += 8 + chunkBytes + (chunkBytes & 1);
+    }
+    return false;
+}
+
+std::vector<uint8_t> makePcm16Wav(const int16_t* samples, size_t frames, uint32_t sampleRate, uint16_t channels) {
+    uint32_t dataBytes = static_cast<uint32_t>(frames * channels * 2);
+    std::vector<uint8_t> wav(44 + dataBytes);
+    std::memcpy(&wav[0], "RIFF", 4);
+    write32(wav, 4, 36 + dataBytes);
+    std::memcpy(&wav[8], "WAVEfmt ", 8);
+    write32(wav, 16, 16);
+    write16(wav, 20, 1);
+    write16(wav, 22, channels);
+    write32(wav, 24, sampleRate);
+    write32(wav, 28, sampleRate * channels * 2);
+    write16(wav, 32, static_cast<uint16_t>(channels * 2));
+    write16(wav, 34, 16);
+    std::memcpy(&wav[36], "data", 4);
+    write32(wav, 40, dataBytes);
+    if (dataBytes) std::memcpy(&wav[44], samples, dataBytes);
+    return wav;
+}
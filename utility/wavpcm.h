@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Where the samples of a 16-bit PCM WAV are, as found by readPcm16.
+ */
+struct PcmLayout {
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    size_t dataOffset = 0;  /**< First sample byte, just after the data chunk header. */
+    size_t dataBytes = 0;
+
+    size_t frames() const { return channels ? dataBytes / (2 * channels) : 0; }
+};
+
+/**
+ * @brief Finds the fmt and data chunks of a RIFF/WAVE buffer.
+ * @return False unless the audio is 16-bit PCM with samples at an even offset,
+ *         so they can be read in place as int16_t.
+ */
+bool readPcm16(const std::vector<uint8_t>& wav, PcmLayout& layout);
+
+/**
+ * @brief Builds a canonical 44-byte-header WAV around 16-bit samples.
+ */
+std::vector<uint8_t> makePcm16Wav(const int16_t* samples, size_t frames, uint32_t sampleRate, uint16_t channels);
@@ -1,18 +1,18 @@
 #include <iostream>
-#include <sstream>
 #include <fstream>
 #include <random>
 #include <algorithm>
-#include <cstdlib>
-#include "utility/AudioPlayer.h"
+#include "utility/SdlAudioSink.h"
+#include "utility/ttsclient.h"
+#include "utility/audiocache.h"
+#include "utility/querycache.h"
+#include "utility/speakercatalog.h"
 #include "include/nlohmann/json.hpp"
 
 //TODO: Remove AudioPlayer class and link audio.h in utility
 using json = nlohmann::json;
 
-//TODO: We don't need python interpreter anymore as we made tts.cpp to handle this
-const std::string PYTHON_INTERPRETER = "/usr/bin/python3";
-const std::string PYTHON_SCRIPT = "voiceSynth.py";
+const char TUTOR_VOICE[] = "Kyushu Sora/Sexy";
 
 class Student {
 private:
@@ -28,47 +28,43 @@ public:
     void updateScore(int points) { score_ += points; }
 };
 
-void executePythonScript(const std::string& pythonInterpreter, const std::string& pythonScript, const std::string& text, int presetId, int speaker) {
-    std::stringstream commandStream;
-    commandStream << pythonInterpreter << " " << pythonScript << " \"" << text << "\" " << presetId << " " << speaker;
-    std::string command = commandStream.str();
-
-    int result = system(command.c_str());
-
-    if (result == 0) {
-        std::cout << "Python script executed successfully." << std::endl;
-    } else {
-        std::cerr << "Error executing Python script. Return code: " << result << std::endl;
+/**
+ * @brief Synthesizes text in-process and plays it from memory.
+ *        Replaces the voiceSynth.py round trip (a shell, a Python interpreter
+ *        and an audio.wav file per utterance).
+ * @return False if the engine failed.
+ */
+bool speak(VoiceClient& voice, AudioSink& audio, const std::string& text, int speaker) {
+    SynthesisParams params;
+    params.text = text;
+    params.speaker = speaker;
+    params.intonationScale = 2.0;  // what voiceSynth.py used
+
+    SynthesisResult result = voice.synthesize(params).get();
+    if (!result.ok) {
+        std::cerr << "Speech synthesis failed: " << result.error << std::endl;
+        return false;
     }
+    std::cout << (result.cached ? "Cached speech in " : "Synthesized speech in ") << result.latencyMs << " ms" << std::endl;
+
+    // Wait for the end of the clip, so the next prompt follows without overlap or a fixed pause.
+    std::future<void> done = audio.playAsync(result.audio);
+    done.wait();
+    return true;
 }
 
 class Tutor {
 public:
+    Tutor(VoiceClient& voice, AudioSink& audio, int speaker)
+        : voice_(voice), audio_(audio), speaker_(speaker) {}
+
     void startLesson(Student& student) {
-        std::string pythonInterpreter = PYTHON_INTERPRETER;
-        std::string pythonScript = PYTHON_SCRIPT;
         std::cout << "Welcome, " << student.getName() << "!" << std::endl;
         std::cout << "Let's begin the Japanese lesson." << std::endl;
 
-        int presetId = 1;
-        int speaker = 17;
-
         std::string text = "Welcome " + student.getName() + ". Let's begin the Japanese lesson.";
 
-        try {
-            executePythonScript(pythonInterpreter, pythonScript, text, presetId, speaker);
-        } catch (const std::exception& e) {
-            std::cerr << "Error executing Python script: " << e.what() << std::endl;
-            return;
-        }
-
-        AudioPlayer audioPlayer;
-
-        if (audioPlayer.loadAudio("audio.wav")) {
-            audioPlayer.play();
-        } else {
-            std::cerr << "Failed to load audio." << std::endl;
-        }
+        speak(voice_, audio_, text, speaker_);
 
         int lessonScore = 80;
         student.updateScore(lessonScore);
@@ -76,6 +72,11 @@ public:
         std::cout << "Lesson completed!" << std::endl;
         std::cout << "Your score: " << student.getScore() << std::endl;
     }
+
+private:
+    VoiceClient& voice_;
+    AudioSink& audio_;  /**< Owned by main. */
+    int speaker_;
 };
 
 class VocabularyQuiz {
@@ -88,6 +89,11 @@ public:
 
     void startQuiz() {
         json& vocabulary = data_["vocabulary"]; 
+        // Decoded once up front so the feedback plays the moment an answer is checked.
+        // Only with a device: a headless sink has nothing to decode into.
+        AudioEngine& engine = AudioEngine::instance();
+        AudioEngine::SoundId incorrectSound = engine.isOpen() ? engine.load("no", "wav/no.wav") : AudioEngine::INVALID_SOUND;
+
         std::shuffle(vocabulary.begin(), vocabulary.end(), std::mt19937(std::random_device()()));
 
         int correctCount = 0;
@@ -119,6 +125,7 @@ public:
                 lastWord = question + " (" + answer + ")";
             } else {
                 std::cout << "Incorrect!" << std::endl;
+                engine.play(incorrectSound);
                 std::cout << "The correct answer is: " << answer << std::endl;
                 word["recall_level"] = word["recall_level"].get<int>() - 1;
                 score -= 5;
@@ -155,26 +162,33 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    std::string text = "ユー オウド ミー 1万円";
-    int presetId = 1;
-    int speaker = 17;
+    SpeakerCatalog speakers;
+    speakers.load();
+    int speaker = speakers.resolve(TUTOR_VOICE);
+    if (speaker < 0) speaker = SynthesisParams().speaker;
+
+    AudioCache cache;  // caches are declared first so they outlive the client
+    QueryCache queries;
+    VoiceClient voice;
+    std::future<size_t> speakerReady = warmUpSpeakers({ speaker }, voice.baseUrl());
+    std::string version = voice.fetchEngineVersion();
+    cache.setEngineVersion(version);
+    queries.setEngineVersion(version);
+    voice.setCache(&cache);
+    voice.setQueryCache(&queries);
 
-    executePythonScript(PYTHON_INTERPRETER, PYTHON_SCRIPT, text, presetId, speaker);
+    std::string text = "ユー オウド ミー 1万円";
+    // Speech and prompts are 24 kHz mono; a short buffer makes answer feedback immediate.
+    AudioEngine::instance().configure(AudioConfig::lowLatency());
+    std::unique_ptr<AudioSink> audio = openAudioSink();
+    speak(voice, *audio, text, speaker);
 
     Student student("John Doe");
-    Tutor tutor;
+    Tutor tutor(voice, *audio, speaker);
     tutor.startLesson(student);
 
     std::string filename = argv[1];
 
-    AudioPlayer audioPlayer;
-
-    if (audioPlayer.loadAudio("audio.wav")) {
-        audioPlayer.play();
-    } else {
-        std::cerr << "Failed to load audio." << std::endl;
-    }
-
     VocabularyQuiz quiz;
     quiz.loadVocabulary(filename);
     quiz.startQuiz();
@@ -18,23 +18,34 @@
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <map>
+#include <cstdlib>
 
 using json = nlohmann::json;
 
 class CurlRequest {
 public:
-    CurlRequest() {
-        curl_global_init(CURL_GLOBAL_DEFAULT);
+    CurlRequest() : baseUrl_(defaultBaseUrl()) {
+        static CurlGlobal global;  // curl_global_init once per process, not per instance
+        (void)global;
         curl = curl_easy_init();
+
+        // Every request sends one of these; they are built once, not per request.
+        jsonHeaders = curl_slist_append(NULL, "Accept: application/json");
+        wavHeaders = curl_slist_append(NULL, "Accept: audio/wav");
+        wavHeaders = curl_slist_append(wavHeaders, "Content-Type: application/json");
     }
 
     ~CurlRequest() {
         if(curl) {
             curl_easy_cleanup(curl);
         }
-        curl_global_cleanup();
+        curl_slist_free_all(jsonHeaders);
+        curl_slist_free_all(wavHeaders);
     }
 
+    CurlRequest(const CurlRequest&) = delete;
+    CurlRequest& operator=(const CurlRequest&) = delete;
+
     std::string urlEncode(const std::string& value) {
         char* encoded_value = curl_easy_escape(curl, value.c_str(), value.length());
         std::string result;
@@ -48,11 +59,8 @@ public:
     json postRequest(const std::string& url, const std::string& data) {
         std::string response;
         if(curl) {
-            struct curl_slist *headers = NULL;
-            headers = curl_slist_append(headers, "Accept: application/json");
-
             curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, jsonHeaders);
             curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
 
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
@@ -63,8 +71,6 @@ public:
                 std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
                 return {{"error", curl_easy_strerror(res)}};
             }
-
-            curl_slist_free_all(headers);
         }
 
         return json::parse(response);
@@ -78,13 +84,10 @@ public:
         }
 
         if(curl) {
-            struct curl_slist *headers = NULL;
-            headers = curl_slist_append(headers, "Accept: audio/wav");
-            headers = curl_slist_append(headers, "Content-Type: application/json");
-
             curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.dump().c_str());
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, wavHeaders);
+            std::string body = data.dump();  // must outlive curl_easy_perform
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
 
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_data);
             curl_easy_setopt(curl, CURLOPT_WRITEDATA, &outFile);
@@ -93,15 +96,13 @@ public:
             if(res != CURLE_OK) {
                 std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
             }
-
-            curl_slist_free_all(headers);
         }
 
         outFile.close();
     }
 
     std::string buildUrl(const std::string& endpoint, const std::map<std::string, std::string>& params) {
-        std::string url = BASE_URL + endpoint;
+        std::string url = baseUrl_ + endpoint;
         if (!params.empty()) {
             url += "?";
             for (const auto& param : params) {
@@ -113,9 +114,26 @@ public:
     }
 
 private:
-    static const std::string BASE_URL;
+    struct CurlGlobal {
+        CurlGlobal() { curl_global_init(CURL_GLOBAL_DEFAULT); }
+        ~CurlGlobal() { curl_global_cleanup(); }
+    };
+
+    static const char BASE_URL[];
+
+    // $VOICEVOX_URL points the tool at another engine (or the mock_voicevox stand-in).
+    static std::string defaultBaseUrl() {
+        const char* url = std::getenv("VOICEVOX_URL");
+        std::string base = url && *url ? url : BASE_URL;
+        if (base.back() != '/') base += '/';
+        return base;
+    }
+
+    std::string baseUrl_;
 
     CURL *curl;
+    struct curl_slist *jsonHeaders;  // Accept: application/json
+    struct curl_slist *wavHeaders;   // Accept: audio/wav, Content-Type: application/json
 
     static size_t write_callback(void *contents, size_t size, size_t nmemb, std::string *s) {
         size_t newLength = size * nmemb;
@@ -130,7 +148,7 @@ private:
     }
 };
 
-const std::string CurlRequest::BASE_URL = "http://127.0.0.1:50021/";
+const char CurlRequest::BASE_URL[] = "http://127.0.0.1:50021/";
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {